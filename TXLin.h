@@ -14,6 +14,7 @@ LICENSE file in the source folder for more info.
 #include <unistd.h>
 #include <cstdlib>
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <cstring>
 #include <iostream>
 #include <fstream>
@@ -26,9 +27,21 @@ LICENSE file in the source folder for more info.
 #include <assert.h>
 #include <string>
 #include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
 #include <execinfo.h>
 #ifdef TXLIN_PTHREAD
 #include <pthread.h>
+#include <atomic>
+#include <deque>
+#include <sched.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
 #endif
 
 #define HWND Uint32
@@ -130,11 +143,44 @@ LICENSE file in the source folder for more info.
 #define VK_CONTROL SDL_SCANCODE_LCTRL
 #define VK_MENU SDL_SCANCODE_LALT
 
+#define WM_SIZE 0x0005
+#define WM_SETFOCUS 0x0007
+#define WM_KILLFOCUS 0x0008
+#define WM_CLOSE 0x0010
+#define WM_KEYDOWN 0x0100
+#define WM_KEYUP 0x0101
+#define WM_MOUSEMOVE 0x0200
+#define WM_LBUTTONDOWN 0x0201
+#define WM_LBUTTONUP 0x0202
+#define WM_RBUTTONDOWN 0x0204
+#define WM_RBUTTONUP 0x0205
+#define WM_MBUTTONDOWN 0x0207
+#define WM_MBUTTONUP 0x0208
+#define WM_MOUSEWHEEL 0x020A
+
+#define TX_STAT_SETPIXEL 0
+#define TX_STAT_GETPIXEL 1
+#define TX_STAT_LINE 2
+#define TX_STAT_RECTANGLE 3
+#define TX_STAT_POLYGON 4
+#define TX_STAT_ELLIPSE 5
+#define TX_STAT_FLOODFILL 6
+#define TX_STAT_CLEAR 7
+#define TX_STAT_TEXT 8
+#define TX_STAT_FONTOPEN 9
+#define TX_STAT_BLIT 10
+#define TX_STAT_PRESENT 11
+#define TX_STAT_COUNT 12
+
+#define TX_RECORD_DROP 0
+#define TX_RECORD_BLOCK 1
+#define TX_RECORD_EVERYFRAME 2
+
 // debug define
 #ifdef TXLIN_DEBUG
 #define DBGOUT if (0) std::cerr << "[TXLin/DEBUG/" << __LINE__ << "] "
 #else
-#define DBGOUT std::stringstream()
+#define DBGOUT while (false) std::cerr
 #endif
 #define DBGINT(var) DBGOUT << #var << " = " << var << std::endl
 #define TXLIN_WARNING(text) { if (getenv("TXLIN_DISABLEAPPWARNINGS") == nullptr) { std::cerr << "[TXLin/WARNING] " << text << std::endl; } }
@@ -196,6 +242,16 @@ LICENSE file in the source folder for more info.
 #define TA_CENTER 5
 #define TA_TOP 6
 #define TA_BOTTOM 7
+#define ALTERNATE 1
+#define WINDING 2
+#define PS_ENDCAP_ROUND 0x00000000
+#define PS_ENDCAP_SQUARE 0x00000100
+#define PS_ENDCAP_FLAT 0x00000200
+#define PS_ENDCAP_MASK 0x00000F00
+#define PS_JOIN_ROUND 0x00000000
+#define PS_JOIN_BEVEL 0x00001000
+#define PS_JOIN_MITER 0x00002000
+#define PS_JOIN_MASK 0x0000F000
 
 #define SND_ASYNC 80
 #define SND_SYNC 81
@@ -223,12 +279,59 @@ LICENSE file in the source folder for more info.
 #define TXLIN_UNPORTABLEDEF_EVENTPROCESSING_QUIT 1
 #define TXLIN_UNPORTABLEDEF_EVENTPROCESSING_NONE 2
 
+#define TXLIN_UNPORTABLEDEF_COMMAND_POINT 0
+#define TXLIN_UNPORTABLEDEF_COMMAND_LINE 1
+#define TXLIN_UNPORTABLEDEF_COMMAND_RECT 2
+#define TXLIN_UNPORTABLEDEF_COMMAND_FILLRECT 3
+#define TXLIN_UNPORTABLEDEF_COMMAND_CLEAR 4
+
+#define TXLIN_UNPORTABLEDEF_GLYPHMODE_SOLID 0
+#define TXLIN_UNPORTABLEDEF_GLYPHMODE_BLENDED 1
+#define TXLIN_UNPORTABLEDEF_GLYPHATLAS_WIDTH 512
+
+#define TXLIN_UNPORTABLEDEF_BLIT_COPY 0
+#define TXLIN_UNPORTABLEDEF_BLIT_COLORKEY 1
+#define TXLIN_UNPORTABLEDEF_BLIT_ALPHA 2
+
+#define TXLIN_UNPORTABLEDEF_TILESIZE 128
+#define TXLIN_UNPORTABLEDEF_TILEDBATCH 262144
+#define TXLIN_UNPORTABLEDEF_TILEDMINPIXELS 65536
+
+#define TXLIN_UNPORTABLEDEF_INPUTEVENTS 256
+#define TXLIN_UNPORTABLEDEF_DAMAGERECTS 32
+
+#define TXLIN_UNPORTABLEDEF_PERFORMANCESIZE 256
+#define TXLIN_UNPORTABLEDEF_PERFORMANCETIME 100
+// txQueryPerformance reports repetitions of its test picture per second in units of this many, it is a scale, not a measured machine
+#define TXLIN_UNPORTABLEDEF_PERFORMANCEREFERENCE 4000.0
+
+// without TXLIN_STATS the counters are not compiled in at all
+#ifdef TXLIN_STATS
+#ifdef TXLIN_PTHREAD
+#define TXLIN_UNPORTABLEDEF_STATVALUE std::atomic<Uint64>
+#else
+#define TXLIN_UNPORTABLEDEF_STATVALUE Uint64
+#endif
+#define TXLIN_UNPORTABLEDEF_STATSCOPE(counter) TXTYPE_STATSCOPE txLinUnportableStatScope(counter)
+#define TXLIN_UNPORTABLEDEF_STATPIXELS(pixels) txLinUnportableAddStatPixels(pixels)
+#else
+#define TXLIN_UNPORTABLEDEF_STATSCOPE(counter)
+#define TXLIN_UNPORTABLEDEF_STATPIXELS(pixels)
+#endif
+#define TXLIN_UNPORTABLEDEF_IMAGECACHEBYTES (64 * 1024 * 1024)
+#define TXLIN_UNPORTABLEDEF_MAXIMAGEPIXELS (1 << 28)
+#define TXLIN_UNPORTABLEDEF_RECORDBUFFERS 8
+#define TXLIN_UNPORTABLEDEF_STATSFONT "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.:"
+
 #define TM_DEFAULT SDL_SYSTEM_CURSOR_ARROW
 #define TM_WAIT SDL_SYSTEM_CURSOR_WAIT
 #define TM_PROHIBITED SDL_SYSTEM_CURSOR_NO
 #define TM_HAND SDL_SYSTEM_CURSOR_HAND
 #define TM_NONE (CURSORREF)(14)
 
+#define IMAGE_BITMAP 0
+#define LR_LOADFROMFILE 0x00000010
+
 #define MB_ABORTRETRYIGNORE 0x00000002L
 #define MB_CANCELTRYCONTINUE 0x00000006L
 #define MB_OK 0x00000000L
@@ -283,6 +386,10 @@ LICENSE file in the source folder for more info.
 #warning "_TX_ALLOW_KILL_PARENT is ignored by TXLin."
 #endif
 
+#ifdef TXLIN_FAST_UNSTABLE_FLOODFILL
+#warning "TXLIN_FAST_UNSTABLE_FLOODFILL is ignored by TXLin, txFloodFill now always uses the scanline algorithm."
+#endif
+
 #ifndef TXLIN_MACOS_VOICEOVERVOICE
 #define TXLIN_MACOS_VOICEOVERVOICE "Daniel"
 #endif
@@ -327,9 +434,218 @@ struct SMALL_RECT {
     unsigned int Bottom;
 };
 
+// one queued primitive, replayed by txLinUnportableFlushCommands
+struct TXTYPE_DRAWCOMMAND {
+    int type;
+    Uint8 r;
+    Uint8 g;
+    Uint8 b;
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+};
+
 struct TXTYPE_SDLSURFRENDER {
     SDL_Surface* surface;
     SDL_Renderer* renderer;
+    std::vector<TXTYPE_DRAWCOMMAND> commands;
+    bool offscreen;
+    bool tiled;
+};
+
+#ifdef TXLIN_PTHREAD
+// a primitive drawn by a worker thread, waiting for the main thread to pick it up
+struct TXTYPE_THREADCOMMAND {
+    SDL_Renderer* dc;
+    TXTYPE_DRAWCOMMAND command;
+    TXTYPE_THREADCOMMAND* next;
+};
+#endif
+
+// tasks started with txRunTask are counted here until they finish
+struct TXTYPE_TASKGROUP {
+#ifdef TXLIN_PTHREAD
+    std::atomic<int> pending{0};
+#else
+    int pending = 0;
+#endif
+};
+
+// one slice of a txParallelFor range
+template <typename Function> struct TXTYPE_PARALLELFORCHUNK {
+    Function* function;
+    int begin;
+    int end;
+};
+
+#ifdef TXLIN_PTHREAD
+struct TXTYPE_POOLTASK {
+    void (*function)(void*);
+    void* argument;
+    TXTYPE_TASKGROUP* group;
+};
+
+// every pool thread owns one deque: it takes its own tasks from the back, other threads steal from the front
+struct TXTYPE_WORKQUEUE {
+    pthread_mutex_t mutex;
+    std::deque<TXTYPE_POOLTASK> tasks;
+};
+#endif
+
+// a non-horizontal polygon edge, oriented top to bottom, for the scanline fill
+struct TXTYPE_POLYEDGE {
+    double yTop;
+    double yBottom;
+    double xTop;
+    double slope;
+    int winding;
+};
+
+// direct access to the pixels of a DC between txLockPixels and txUnlockPixels
+struct TXTYPE_PIXELBUFFER {
+    Uint32* pixels;
+    int width;
+    int height;
+    int pitch;
+    SDL_Surface* surface;
+    SDL_Renderer* dc;
+};
+
+// one keyboard, mouse or window event, read with txGetInputEvent
+struct TXTYPE_INPUTEVENT {
+    unsigned message;
+    int key;
+    int x;
+    int y;
+    int wheel;
+    Uint32 time;
+};
+
+// measures the time until the end of its scope, in milliseconds
+struct TXTYPE_SCOPEDTIMER {
+    const char* name;
+    double* result;
+    Uint64 start;
+
+    TXTYPE_SCOPEDTIMER(const char* timerName = nullptr, double* timerResult = nullptr) : name(timerName), result(timerResult), start(SDL_GetPerformanceCounter()) {}
+
+    double elapsed() const {
+        return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    }
+
+    ~TXTYPE_SCOPEDTIMER() {
+        double time = elapsed();
+        if (result != nullptr)
+            *result = time;
+        if (name != nullptr)
+            std::cerr << name << ": " << time << " ms" << std::endl;
+    }
+};
+
+// what one API entry point cost during the last frame, read with txGetStat
+struct TXTYPE_STATCOUNTER {
+    const char* name;
+    unsigned long calls;
+    unsigned long pixels;
+    double time;
+};
+
+// the window, renderer and surface behind txDC(), resolved once per window
+struct TXTYPE_DCCONTEXT {
+    Uint32 windowId;
+    SDL_Window* window;
+    SDL_Renderer* renderer;
+    SDL_Surface* surface;
+    bool softwareRenderer;
+};
+
+// one glyph inside a font atlas, positioned relative to the pen
+struct TXTYPE_GLYPH {
+    SDL_Rect rect;
+    int offsetX;
+    int advance;
+};
+
+// glyphs are rendered in white once and tinted with a color mod when blitted
+struct TXTYPE_GLYPHATLAS {
+    SDL_Surface* surface;
+    int shelfX;
+    int shelfY;
+    int shelfHeight;
+    std::map<Uint32, TXTYPE_GLYPH> glyphs;
+};
+
+// advances are memoized separately from the atlases so that measuring text never rasterizes it
+struct TXTYPE_FONTCACHE {
+    TTF_Font* font;
+    TXTYPE_GLYPHATLAS atlases[2];
+    int asciiAdvances[128];
+    std::map<Uint32, int> advances;
+};
+
+// a canonical Huffman code for inflate: how many codes there are of each length and the symbols sorted by code
+struct TXTYPE_HUFFMAN {
+    Uint16 counts[16];
+    Uint16 symbols[320];
+};
+
+// reads a deflate stream bit by bit, least significant bit first
+struct TXTYPE_INFLATESTATE {
+    const Uint8* data;
+    size_t size;
+    size_t position;
+    Uint32 bitBuffer;
+    int bitCount;
+    bool error;
+};
+
+// a decoded image file, kept by txLoadImage until the file changes on disk
+struct TXTYPE_IMAGECACHE {
+    std::vector<Uint32> pixels;
+    int width;
+    int height;
+    bool alpha;
+    time_t modified;
+    off_t fileSize;
+    Uint64 lastUse;
+};
+
+// a copy of the window waiting to be written, repeated to cover the time it stayed on the screen
+struct TXTYPE_RECORDFRAME {
+    std::vector<Uint32> pixels;
+    Uint64 repeat;
+};
+
+// txStartRecording state: the main thread fills free buffers, the writer turns ready ones into the file
+struct TXTYPE_RECORDER {
+    FILE* file;
+    bool y4m;
+    unsigned flags;
+    int width;
+    int height;
+    Uint32 format;
+    int shifts[3];
+    Uint64 fpsNumerator;
+    Uint64 fpsDenominator;
+    Uint64 start;
+    // the frame shown since frame slot pendingSlot, not handed to the writer until the next one replaces it
+    int pending;
+    Uint64 pendingSlot;
+    Uint64 droppedSlot;
+    std::vector<TXTYPE_RECORDFRAME> buffers;
+    std::vector<int> freeBuffers;
+    std::vector<int> readyBuffers;
+    std::vector<Uint8> output;
+    unsigned long written;
+    unsigned long dropped;
+    bool failed;
+    bool stopping;
+#ifdef TXLIN_PTHREAD
+    pthread_t writer;
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+#endif
 };
 
 inline bool operator==(const COLORREF& c1, const COLORREF& c2) {
@@ -349,6 +665,13 @@ namespace TX {
     static HWND txLinUnportableRecentlyCreatedWindow = -1;
     static unsigned txLinUnportableLastTerminalColor = 0x07;
     static bool txLinUnportableAutomaticWindowUpdates = true;
+    static int txLinUnportableFrameDepth = 0;
+    // frame pacing, all times are in SDL performance counter ticks
+    static double txLinUnportableTargetFPS = 0;
+    static Uint64 txLinUnportableFrameStart = 0;
+    static Uint64 txLinUnportableFrameDeadline = 0;
+    static unsigned txLinUnportableMissedFrames = 0;
+    static bool txLinUnportableVSync = false;
     static int TXLIN_TEXTSET_MAXWIDTH = 12;
     static int TXLIN_TEXTSET_MAXHEIGHT = 12;
     static COLORREF txLinUnportableLastFillColor = TX_TRANSPARENT;
@@ -356,13 +679,82 @@ namespace TX {
     static unsigned txLinUnportableTextAlign = TA_BOTTOM;
     static bool txLinUnportableAllowExit = true;
     static int txLinUnportableLineThickness = 1;
+    static int txLinUnportablePolyFillMode = ALTERNATE;
+    static unsigned txLinUnportableLineStyle = PS_ENDCAP_ROUND | PS_JOIN_ROUND;
     static bool txLinUnportableUseMonolithic = false;
+    // DC handle table: slots of deleted DCs are reused, the map gives the slot of a renderer
     static std::vector<TXTYPE_SDLSURFRENDER> txLinUnportableDCSurfaces = std::vector<TXTYPE_SDLSURFRENDER>();
+    static std::vector<size_t> txLinUnportableFreeDCSlots = std::vector<size_t>();
+    static std::unordered_map<HDC, size_t> txLinUnportableDCSlots = std::unordered_map<HDC, size_t>();
+    // DCs in tiled mode queue their commands even outside of txBegin/txEnd
+    static int txLinUnportableTiledDCs = 0;
+    static TXTYPE_DCCONTEXT txLinUnportableContext = { 0, nullptr, nullptr, nullptr, false };
+    // in headless mode the "window" is a memory surface with a software renderer and no SDL_Window
+    static TXTYPE_DCCONTEXT txLinUnportableHeadlessContext = { 0, nullptr, nullptr, nullptr, false };
+#ifdef TXLIN_HEADLESS
+    static bool txLinUnportableHeadless = true;
+#else
+    static bool txLinUnportableHeadless = false;
+#endif
+#ifdef TXLIN_PTHREAD
+    // statics are initialized before main(), so this is the thread that owns SDL
+    static pthread_t txLinUnportableMainThread = pthread_self();
+    static std::atomic<TXTYPE_THREADCOMMAND*> txLinUnportableThreadCommands(nullptr);
+    // drained nodes come back in whole chains and workers take the whole list at once, so reusing them has no ABA problem
+    static std::atomic<TXTYPE_THREADCOMMAND*> txLinUnportableFreeThreadCommands(nullptr);
+    // txLock mutexes are created on demand, the table itself is shared by all threads
+    static pthread_mutex_t txLinUnportableLockTableMutex = PTHREAD_MUTEX_INITIALIZER;
+    static std::unordered_map<HDC, pthread_mutex_t*> txLinUnportableDCLocks = std::unordered_map<HDC, pthread_mutex_t*>();
+    static std::atomic<int> txLinUnportableHeldLocks(0);
+    // queue 0 belongs to the threads outside of the pool, the pool threads use the rest;
+    // the pool lives until the process exits, so the array is never freed under running workers
+    static TXTYPE_WORKQUEUE** txLinUnportablePoolQueues = nullptr;
+    static std::atomic<int> txLinUnportablePoolSize(0);
+    static pthread_mutex_t txLinUnportablePoolMutex = PTHREAD_MUTEX_INITIALIZER;
+    static pthread_cond_t txLinUnportablePoolCondition = PTHREAD_COND_INITIALIZER;
+    static std::atomic<int> txLinUnportablePoolQueued(0);
+    static thread_local int txLinUnportablePoolIndex = 0;
+#else
+    static int txLinUnportableHeldLocks = 0;
+#endif
+    static std::map<std::pair<std::string, int>, TXTYPE_FONTCACHE> txLinUnportableFontCache;
+    static std::map<std::string, TXTYPE_IMAGECACHE> txLinUnportableImageCache;
+    static size_t txLinUnportableImageCacheBytes = 0;
+    static Uint64 txLinUnportableImageCacheClock = 0;
+    static TXTYPE_RECORDER* txLinUnportableRecorder = nullptr;
+    static unsigned long txLinUnportableRecorderDropped = 0;
+    // input ring buffer: the oldest event is dropped when it overflows
+    static TXTYPE_INPUTEVENT txLinUnportableInputEvents[TXLIN_UNPORTABLEDEF_INPUTEVENTS];
+    static int txLinUnportableInputFirst = 0;
+    static int txLinUnportableInputCount = 0;
+#ifdef TXLIN_PTHREAD
+    static pthread_mutex_t txLinUnportableInputMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+    // parts of the window changed since the last update, a software-rendered window only sends these to the screen
+    static std::vector<SDL_Rect> txLinUnportableDamage = std::vector<SDL_Rect>();
+    static bool txLinUnportableFullDamage = true;
+    static const char* txLinUnportableStatNames[TX_STAT_COUNT] = { "SETPIXEL", "GETPIXEL", "LINE", "RECTANGLE", "POLYGON", "ELLIPSE", "FLOODFILL", "CLEAR", "TEXT", "FONTOPEN", "BLIT", "PRESENT" };
+#ifdef TXLIN_STATS
+    // the frame being drawn is counted by all threads, txGetStat reads the last finished one
+    static TXLIN_UNPORTABLEDEF_STATVALUE txLinUnportableStatCalls[TX_STAT_COUNT];
+    static TXLIN_UNPORTABLEDEF_STATVALUE txLinUnportableStatPixels[TX_STAT_COUNT];
+    static TXLIN_UNPORTABLEDEF_STATVALUE txLinUnportableStatTicks[TX_STAT_COUNT];
+    static TXTYPE_STATCOUNTER txLinUnportableLastStats[TX_STAT_COUNT];
+    // the innermost counted call on this thread, the pixels it submits are added to it
+    static thread_local int txLinUnportableStatCurrent = -1;
+    static bool txLinUnportableStatsOverlay = false;
+    static SDL_Rect txLinUnportableStatsOverlayArea = { 0, 0, 0, 0 };
+    // 3x5 glyphs of TXLIN_UNPORTABLEDEF_STATSFONT, one bit per pixel, rows from the top
+    static const unsigned short txLinUnportableStatsGlyphs[] = { 0x7b6f, 0x2c97, 0x73e7, 0x72cf, 0x5bc9, 0x79cf, 0x79ef, 0x7292, 0x7bef, 0x7bcf, 0x2bed, 0x6bae, 0x3923, 0x6b6e, 0x79a7, 0x79a4, 0x396b, 0x5bed, 0x7497, 0x126a, 0x5bad, 0x4927, 0x5fed, 0x6b6d, 0x2b6a, 0x6ba4, 0x2b73, 0x6bad, 0x388e, 0x7492, 0x5b6f, 0x5b6a, 0x5bfd, 0x5aad, 0x5a92, 0x72a7, 0x0002, 0x0410 };
+#endif
 
     inline HDC txDC();
     inline HWND txWindow();
+    inline void txLinUnportableReleaseFonts();
+    inline bool txSetDefaults(HDC dc);
+    inline bool txLinUnportableFlushTiled(TXTYPE_SDLSURFRENDER* entry);
     inline COLORREF txGetFillColor(HDC dc = txDC());
-    inline bool txFloodFill (double x, double y, COLORREF realOld = txGetFillColor(), DWORD mode = FLOODFILLSURFACE, HDC dc = txDC());
+    inline bool txFloodFill (double x, double y, COLORREF realOld = TX_TRANSPARENT, DWORD mode = FLOODFILLSURFACE, HDC dc = txDC());
     inline SIZE txGetTextExtent(const char* text, HDC dc = txDC());
     inline bool txClear(HDC dc = txDC());
     inline HBRUSH txSetFillColor(COLORREF color = TX_TRANSPARENT, HDC dc = txDC());
@@ -371,6 +763,76 @@ namespace TX {
     inline int txMessageBox(const char* text, const char* header = "TXLin", unsigned flags = MB_OK);
     inline void txSetConsoleAttr(unsigned colors = 0x07);
     inline bool txEllipse(double x0, double y0, double x1, double y1, HDC dc = txDC());
+    inline bool txDeleteDC(HDC dc);
+    inline TXTYPE_DCCONTEXT* txLinUnportableCurrentContext();
+
+    inline void txLinUnportableInvalidateContext() {
+        txLinUnportableContext.window = nullptr;
+        txLinUnportableContext.renderer = nullptr;
+        txLinUnportableContext.surface = nullptr;
+        txLinUnportableContext.softwareRenderer = false;
+        txLinUnportableFullDamage = true;
+    }
+
+#ifdef TXLIN_STATS
+    // counts one API call and the time until it returns, calls made inside it are counted too
+    struct TXTYPE_STATSCOPE {
+        int counter;
+        int outer;
+        Uint64 start;
+
+        TXTYPE_STATSCOPE(int statCounter) : counter(statCounter), outer(txLinUnportableStatCurrent), start(SDL_GetPerformanceCounter()) {
+            txLinUnportableStatCalls[counter] += 1;
+            txLinUnportableStatCurrent = counter;
+        }
+
+        ~TXTYPE_STATSCOPE() {
+            txLinUnportableStatTicks[counter] += SDL_GetPerformanceCounter() - start;
+            txLinUnportableStatCurrent = outer;
+        }
+    };
+
+    inline void txLinUnportableAddStatPixels(Uint64 pixels) {
+        if (txLinUnportableStatCurrent >= 0)
+            txLinUnportableStatPixels[txLinUnportableStatCurrent] += pixels;
+    }
+
+    inline Uint64 txLinUnportableCommandPixels(const TXTYPE_DRAWCOMMAND& command) {
+        Uint64 width = (Uint64)(MAX(abs(command.x1 - command.x0), 1));
+        Uint64 height = (Uint64)(MAX(abs(command.y1 - command.y0), 1));
+        switch (command.type) {
+        case TXLIN_UNPORTABLEDEF_COMMAND_POINT:
+            return 1;
+        case TXLIN_UNPORTABLEDEF_COMMAND_LINE:
+            return MAX(width, height) + 1;
+        case TXLIN_UNPORTABLEDEF_COMMAND_RECT:
+            return 2 * (width + height);
+        case TXLIN_UNPORTABLEDEF_COMMAND_FILLRECT:
+            return width * height;
+        default:
+            return 0; // a clear counts the whole DC in txClear
+        }
+    }
+#endif
+
+    // the counters of the frame that just ended become the ones txGetStat and the overlay show
+    inline void txLinUnportableStatsEndFrame() {
+#ifdef TXLIN_STATS
+        double frequency = (double)(SDL_GetPerformanceFrequency());
+        for (int i = 0; i < TX_STAT_COUNT; i++) {
+            Uint64 calls = txLinUnportableStatCalls[i];
+            Uint64 pixels = txLinUnportableStatPixels[i];
+            Uint64 ticks = txLinUnportableStatTicks[i];
+            txLinUnportableStatCalls[i] = 0;
+            txLinUnportableStatPixels[i] = 0;
+            txLinUnportableStatTicks[i] = 0;
+            txLinUnportableLastStats[i].name = txLinUnportableStatNames[i];
+            txLinUnportableLastStats[i].calls = (unsigned long)(calls);
+            txLinUnportableLastStats[i].pixels = (unsigned long)(pixels);
+            txLinUnportableLastStats[i].time = (double)(ticks) * 1000.0 / frequency;
+        }
+#endif
+    }
 
     inline std::string txLinUnportableNumToCPlusPlusString(int num) {
         std::stringstream stream;
@@ -378,25 +840,83 @@ namespace TX {
         return stream.str();
     }
 
-    inline int txLinUnportableSDLProcessOneEvent() {
-        SDL_Event* eventHandler = (SDL_Event*)(malloc(sizeof(SDL_Event)));
-        if (SDL_PollEvent(eventHandler) == 0) {
-            free(eventHandler);
-            return TXLIN_UNPORTABLEDEF_EVENTPROCESSING_NONE;
+    inline void txLinUnportableRecordInputEvent(unsigned message, Uint32 time, int key = 0, int x = 0, int y = 0, int wheel = 0) {
+        TXTYPE_INPUTEVENT event = { message, key, x, y, wheel, time };
+#ifdef TXLIN_PTHREAD
+        pthread_mutex_lock(&txLinUnportableInputMutex);
+#endif
+        int last = (txLinUnportableInputFirst + txLinUnportableInputCount - 1) % TXLIN_UNPORTABLEDEF_INPUTEVENTS;
+        if (txLinUnportableInputCount == TXLIN_UNPORTABLEDEF_INPUTEVENTS && message == WM_MOUSEMOVE && txLinUnportableInputEvents[last].message == WM_MOUSEMOVE)
+            txLinUnportableInputEvents[last] = event; // a full buffer keeps only the latest of several mouse moves in a row
+        else {
+            if (txLinUnportableInputCount == TXLIN_UNPORTABLEDEF_INPUTEVENTS) {
+                txLinUnportableInputFirst = (txLinUnportableInputFirst + 1) % TXLIN_UNPORTABLEDEF_INPUTEVENTS;
+                txLinUnportableInputCount--;
+            }
+            txLinUnportableInputEvents[(txLinUnportableInputFirst + txLinUnportableInputCount) % TXLIN_UNPORTABLEDEF_INPUTEVENTS] = event;
+            txLinUnportableInputCount++;
+        }
+#ifdef TXLIN_PTHREAD
+        pthread_mutex_unlock(&txLinUnportableInputMutex);
+#endif
+    }
+
+    inline int txLinUnportableSDLProcessOneEvent(const SDL_Event& event) {
+        if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+            txLinUnportableInvalidateContext();
+            txLinUnportableRecordInputEvent(WM_SIZE, event.window.timestamp, 0, event.window.data1, event.window.data2);
         }
-        if (eventHandler->type == SDL_QUIT && txLinUnportableAllowExit) {
-            free(eventHandler);
+        else if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_EXPOSED)
+            txLinUnportableFullDamage = true;
+        else if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_FOCUS_GAINED)
+            txLinUnportableRecordInputEvent(WM_SETFOCUS, event.window.timestamp);
+        else if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_FOCUS_LOST)
+            txLinUnportableRecordInputEvent(WM_KILLFOCUS, event.window.timestamp);
+        else if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP)
+            txLinUnportableRecordInputEvent((event.type == SDL_KEYDOWN) ? WM_KEYDOWN : WM_KEYUP, event.key.timestamp, (int)(event.key.keysym.scancode));
+        else if (event.type == SDL_MOUSEMOTION)
+            txLinUnportableRecordInputEvent(WM_MOUSEMOVE, event.motion.timestamp, 0, event.motion.x, event.motion.y);
+        else if (event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEBUTTONUP) {
+            bool down = (event.type == SDL_MOUSEBUTTONDOWN);
+            unsigned message = (down) ? WM_LBUTTONDOWN : WM_LBUTTONUP;
+            if (event.button.button == SDL_BUTTON_RIGHT)
+                message = (down) ? WM_RBUTTONDOWN : WM_RBUTTONUP;
+            else if (event.button.button == SDL_BUTTON_MIDDLE)
+                message = (down) ? WM_MBUTTONDOWN : WM_MBUTTONUP;
+            txLinUnportableRecordInputEvent(message, event.button.timestamp, 0, event.button.x, event.button.y);
+        }
+        else if (event.type == SDL_MOUSEWHEEL)
+            txLinUnportableRecordInputEvent(WM_MOUSEWHEEL, event.wheel.timestamp, 0, 0, 0, event.wheel.y);
+        else if (event.type == SDL_QUIT) {
+            if (txLinUnportableAllowExit == false) {
+                txLinUnportableRecordInputEvent(WM_CLOSE, event.quit.timestamp);
+                return TXLIN_UNPORTABLEDEF_EVENTPROCESSING_PROCESSED;
+            }
             SDL_DestroyRenderer(txDC());
             SDL_DestroyWindow(SDL_GetWindowFromID(txWindow()));
+            txLinUnportableReleaseFonts();
             TTF_Quit();
             SDL_Quit();
             exit(0);
             return TXLIN_UNPORTABLEDEF_EVENTPROCESSING_QUIT;
         }
-        free(eventHandler);
         return TXLIN_UNPORTABLEDEF_EVENTPROCESSING_PROCESSED;
     }
 
+    // drains everything SDL has queued, so a burst of mouse motion cannot pile up between two frames
+    inline int txLinUnportableSDLProcessEvents() {
+        if (txLinUnportableHeadless)
+            return TXLIN_UNPORTABLEDEF_EVENTPROCESSING_NONE;
+        SDL_Event event;
+        int result = TXLIN_UNPORTABLEDEF_EVENTPROCESSING_NONE;
+        while (SDL_PollEvent(&event) != 0) {
+            result = txLinUnportableSDLProcessOneEvent(event);
+            if (result == TXLIN_UNPORTABLEDEF_EVENTPROCESSING_QUIT)
+                break;
+        }
+        return result;
+    }
+
     inline void txLinUnportableMacLinuxBacktrace() {
 #ifndef TXLIN_NO_BACKTRACE
         void* addressesBuffer = (void*)(calloc(10, sizeof(unsigned)));
@@ -531,6 +1051,13 @@ namespace TX {
         return (unsigned long)(SDL_GetTicks());
     }
 
+    inline Uint64 txGetTimeNs() {
+        Uint64 counter = SDL_GetPerformanceCounter();
+        Uint64 frequency = SDL_GetPerformanceFrequency();
+        // whole seconds and the remainder are converted apart, so that counter * 10^9 can't overflow
+        return (counter / frequency) * 1000000000ULL + (counter % frequency) * 1000000000ULL / frequency;
+    }
+
     #define Sleep(ms) txSleep(ms)
 
     inline int txPlayVideo(const char* fn) {
@@ -538,14 +1065,23 @@ namespace TX {
             TXLIN_WARNING("txPlayVideo called with NULL argument, won't play anything");
             return -1;
         }
-#ifndef __APPLE__
-        // TODO: Implement support for Linux media players
-        TXLIN_WARNING("txPlayVideo only works on macOS, because currently, only QuickTime X is supported.");
-        return -1;
+        // the name goes between single quotes, so a quote inside it has to close, escape and reopen them
+        std::string quoted = "'";
+        for (const char* c = fn; *c != '\0'; c++)
+            quoted += (*c == '\'') ? std::string("'\\''") : std::string(1, *c);
+        quoted += "'";
+#ifdef __APPLE__
+        std::string cmdQT = "open -a 'QuickTime Player' " + quoted;
+#else
+        // the default player of the desktop, so recordings made with txStartRecording can be watched right away
+        if (std::system("command -v xdg-open > /dev/null 2>&1") != 0) {
+            TXLIN_WARNING("txPlayVideo needs xdg-open to find a media player");
+            return -1;
+        }
+        std::string cmdQT = "xdg-open " + quoted;
 #endif
-        std::string cmdQT = "open -a 'QuickTime Player' '" + fn + "'";
         clock_t startTime = clock() / CLOCKS_PER_SEC;
-        std::system(cmdQT);
+        std::system(cmdQT.c_str());
         clock_t endTime = clock() / CLOCKS_PER_SEC;
         int difference = (int)(endTime - startTime);
         return difference;
@@ -599,7 +1135,7 @@ namespace TX {
     inline bool txLinUnportableInitSDL() {
         signal(SIGTERM, txLinUnportableUnexpectedSignalHandler);
         signal(SIGKILL, txLinUnportableUnexpectedSignalHandler);
-        if ((SDL_Init(SDL_INIT_VIDEO) == 0) == false) {
+        if ((SDL_Init((txLinUnportableHeadless) ? 0 : SDL_INIT_VIDEO) == 0) == false) {
             TXLIN_WARNING("SDL_GetError(): " + std::string(SDL_GetError()) + ", your program probably won't start due to SDL2 problems");
             return false;
         }
@@ -608,6 +1144,9 @@ namespace TX {
             return false;
         }
         txLinUnportableDCSurfaces.clear();
+        txLinUnportableFreeDCSlots.clear();
+        txLinUnportableDCSlots.clear();
+        txLinUnportableHasInitializedTXLinInThisContext = true;
         return true;
     }
 
@@ -617,123 +1156,866 @@ namespace TX {
         return number;
     }
 
-    inline void txRedrawWindow(bool mtFunc = false) {
-        for (int i = 0; i < txLinUnportableDCSurfaces.size(); i++) {
-            if (txLinUnportableDCSurfaces.at(i).renderer != nullptr)
-                SDL_RenderPresent(txLinUnportableDCSurfaces.at(i).renderer);
+    inline TXTYPE_SDLSURFRENDER* txLinUnportableFindDCEntry(HDC dc) {
+        if (dc == nullptr)
+            return nullptr;
+        std::unordered_map<HDC, size_t>::iterator found = txLinUnportableDCSlots.find(dc);
+        if (found == txLinUnportableDCSlots.end())
+            return nullptr;
+        return &(txLinUnportableDCSurfaces[found->second]);
+    }
+
+    inline void txLinUnportableRegisterDC(SDL_Surface* surface, HDC dc, bool offscreen) {
+        if (dc == nullptr || txLinUnportableDCSlots.count(dc) != 0)
+            return;
+        size_t slot = txLinUnportableDCSurfaces.size();
+        if (txLinUnportableFreeDCSlots.empty())
+            txLinUnportableDCSurfaces.push_back(TXTYPE_SDLSURFRENDER());
+        else {
+            slot = txLinUnportableFreeDCSlots.back();
+            txLinUnportableFreeDCSlots.pop_back();
         }
-        SDL_UpdateWindowSurface(SDL_GetWindowFromID(txWindow()));
-        if (mtFunc == false)
-            txLinUnportableSDLProcessOneEvent();
+        TXTYPE_SDLSURFRENDER& entry = txLinUnportableDCSurfaces[slot];
+        entry.surface = surface;
+        entry.renderer = dc;
+        entry.commands.clear();
+        entry.offscreen = offscreen;
+        entry.tiled = false;
+        txLinUnportableDCSlots[dc] = slot;
     }
 
-    inline HWND txCreateWindow(double sizeX, double sizeY, bool centered = true) {
-        if (txLinUnportableHasInitializedTXLinInThisContext && txLinUnportableInitSDL() == false)
-            return -1;
-        int x = SDL_WINDOWPOS_CENTERED;
-        int y = SDL_WINDOWPOS_CENTERED;
-        if (centered == false) {
-            x = 2;
-            y = 2;
+    // returns the surface of the DC that was removed from the table
+    inline SDL_Surface* txLinUnportableUnregisterDC(HDC dc) {
+        std::unordered_map<HDC, size_t>::iterator found = txLinUnportableDCSlots.find(dc);
+        if (dc == nullptr || found == txLinUnportableDCSlots.end())
+            return nullptr;
+        TXTYPE_SDLSURFRENDER& entry = txLinUnportableDCSurfaces[found->second];
+        SDL_Surface* surface = entry.surface;
+        if (entry.tiled)
+            txLinUnportableTiledDCs--;
+        entry.surface = nullptr;
+        entry.tiled = false;
+        entry.renderer = nullptr;
+        entry.commands.clear();
+        txLinUnportableFreeDCSlots.push_back(found->second);
+        txLinUnportableDCSlots.erase(found);
+        return surface;
+    }
+
+    inline bool txLinUnportableDeferredUpdates() {
+        return (txLinUnportableFrameDepth > 0 || txLinUnportableAutomaticWindowUpdates == false);
+    }
+
+    // remembers that a part of dc changed; memory DCs are never shown, so only the window is tracked
+    inline void txLinUnportableAddDamage(HDC dc, int x, int y, int w, int h) {
+        if (dc == nullptr || dc != txLinUnportableContext.renderer || txLinUnportableFullDamage || txLinUnportableContext.surface == nullptr)
+            return;
+        SDL_Rect area = { MAX(x, 0), MAX(y, 0), 0, 0 };
+        area.w = MIN(x + w, txLinUnportableContext.surface->w) - area.x;
+        area.h = MIN(y + h, txLinUnportableContext.surface->h) - area.y;
+        if (area.w <= 0 || area.h <= 0)
+            return;
+        // touching or overlapping rectangles become one, so a widget drawn piece by piece is one update
+        for (size_t i = 0; i < txLinUnportableDamage.size(); i++) {
+            SDL_Rect& known = txLinUnportableDamage[i];
+            if (area.x <= known.x + known.w && known.x <= area.x + area.w && area.y <= known.y + known.h && known.y <= area.y + area.h) {
+                int right = MAX(area.x + area.w, known.x + known.w);
+                int bottom = MAX(area.y + area.h, known.y + known.h);
+                known.x = MIN(area.x, known.x);
+                known.y = MIN(area.y, known.y);
+                known.w = right - known.x;
+                known.h = bottom - known.y;
+                return;
+            }
         }
-        SDL_Window* window = SDL_CreateWindow("TXLin", x, y, (int)(sizeX), (int)(sizeY), SDL_WINDOW_SHOWN);
-        txLinUnportableRecentlyCreatedWindow = SDL_GetWindowID(window);
-        txSetFillColor(TX_BLACK);
-        txClear(txDC());
-        SDL_UpdateWindowSurface(window);
-        TXTYPE_SDLSURFRENDER windowRType = { SDL_GetWindowSurface(window), SDL_GetRenderer(window) };
-        txLinUnportableDCSurfaces.push_back(windowRType);
-        SDL_ShowWindow(window);
-        SDL_RaiseWindow(window);
-        SDL_Delay(500);
-        DBGOUT << "Window shown" << std::endl;
-        return txLinUnportableRecentlyCreatedWindow;
+        txLinUnportableDamage.push_back(area);
+        if (txLinUnportableDamage.size() <= TXLIN_UNPORTABLEDEF_DAMAGERECTS)
+            return;
+        // too scattered to be worth sending separately
+        SDL_Rect bounds = txLinUnportableDamage[0];
+        for (size_t i = 1; i < txLinUnportableDamage.size(); i++) {
+            int right = MAX(bounds.x + bounds.w, txLinUnportableDamage[i].x + txLinUnportableDamage[i].w);
+            int bottom = MAX(bounds.y + bounds.h, txLinUnportableDamage[i].y + txLinUnportableDamage[i].h);
+            bounds.x = MIN(bounds.x, txLinUnportableDamage[i].x);
+            bounds.y = MIN(bounds.y, txLinUnportableDamage[i].y);
+            bounds.w = right - bounds.x;
+            bounds.h = bottom - bounds.y;
+        }
+        txLinUnportableDamage.clear();
+        txLinUnportableDamage.push_back(bounds);
     }
 
-    inline bool txIsLinux() {
-#ifdef __linux__
-        return true;
-#else
-        return false;
-#endif
+    inline void txLinUnportableDamageAll(HDC dc) {
+        if (dc != nullptr && dc == txLinUnportableContext.renderer)
+            txLinUnportableFullDamage = true;
     }
 
-    inline bool txIsMacOS() {
-#ifdef __APPLE__
-        return true;
-#else
-        return false;
+    inline void txLinUnportableAddCommandDamage(HDC dc, const TXTYPE_DRAWCOMMAND& command) {
+        if (dc != txLinUnportableContext.renderer)
+            return;
+        if (command.type == TXLIN_UNPORTABLEDEF_COMMAND_CLEAR)
+            txLinUnportableDamageAll(dc);
+        else if (command.type == TXLIN_UNPORTABLEDEF_COMMAND_LINE)
+            txLinUnportableAddDamage(dc, MIN(command.x0, command.x1), MIN(command.y0, command.y1), txLinUnportableModule(command.x1 - command.x0) + 1, txLinUnportableModule(command.y1 - command.y0) + 1);
+        else if (command.type == TXLIN_UNPORTABLEDEF_COMMAND_POINT)
+            txLinUnportableAddDamage(dc, command.x0, command.y0, 1, 1);
+        else
+            txLinUnportableAddDamage(dc, command.x0, command.y0, MAX(command.x1 - command.x0, 1), MAX(command.y1 - command.y0, 1));
+    }
+
+    inline void txLinUnportableExecuteCommand(HDC dc, const TXTYPE_DRAWCOMMAND& command) {
+        if (command.type == TXLIN_UNPORTABLEDEF_COMMAND_POINT)
+            SDL_RenderDrawPoint(dc, command.x0, command.y0);
+        else if (command.type == TXLIN_UNPORTABLEDEF_COMMAND_LINE)
+            SDL_RenderDrawLine(dc, command.x0, command.y0, command.x1, command.y1);
+        else if (command.type == TXLIN_UNPORTABLEDEF_COMMAND_RECT || command.type == TXLIN_UNPORTABLEDEF_COMMAND_FILLRECT) {
+            SDL_Rect rectangle = { command.x0, command.y0, command.x1 - command.x0, command.y1 - command.y0 };
+            if (command.type == TXLIN_UNPORTABLEDEF_COMMAND_RECT)
+                SDL_RenderDrawRect(dc, &rectangle);
+            else
+                SDL_RenderFillRect(dc, &rectangle);
+        }
+        else if (command.type == TXLIN_UNPORTABLEDEF_COMMAND_CLEAR)
+            SDL_RenderClear(dc);
+    }
+
+    // replays commands [begin, end) through SDL, runs of same-typed, same-colored commands with one batched SDL call each
+    inline void txLinUnportableReplayCommands(HDC dc, const std::vector<TXTYPE_DRAWCOMMAND>& commands, size_t begin, size_t end) {
+        std::vector<SDL_Point> points;
+        std::vector<SDL_Rect> rects;
+        size_t i = begin;
+        while (i < end) {
+            const TXTYPE_DRAWCOMMAND& first = commands.at(i);
+            size_t runEnd = i + 1;
+            while (runEnd < end && commands.at(runEnd).type == first.type && commands.at(runEnd).r == first.r && commands.at(runEnd).g == first.g && commands.at(runEnd).b == first.b)
+                runEnd++;
+            SDL_SetRenderDrawColor(dc, first.r, first.g, first.b, 0);
+            if (first.type == TXLIN_UNPORTABLEDEF_COMMAND_POINT) {
+                points.clear();
+                for (size_t j = i; j < runEnd; j++) {
+                    SDL_Point point = { commands.at(j).x0, commands.at(j).y0 };
+                    points.push_back(point);
+                }
+                SDL_RenderDrawPoints(dc, &(points[0]), (int)(points.size()));
+            }
+            else if (first.type == TXLIN_UNPORTABLEDEF_COMMAND_RECT || first.type == TXLIN_UNPORTABLEDEF_COMMAND_FILLRECT) {
+                rects.clear();
+                for (size_t j = i; j < runEnd; j++) {
+                    const TXTYPE_DRAWCOMMAND& command = commands.at(j);
+                    SDL_Rect rectangle = { command.x0, command.y0, command.x1 - command.x0, command.y1 - command.y0 };
+                    rects.push_back(rectangle);
+                }
+                if (first.type == TXLIN_UNPORTABLEDEF_COMMAND_RECT)
+                    SDL_RenderDrawRects(dc, &(rects[0]), (int)(rects.size()));
+                else
+                    SDL_RenderFillRects(dc, &(rects[0]), (int)(rects.size()));
+            }
+            else {
+                for (size_t j = i; j < runEnd; j++)
+                    txLinUnportableExecuteCommand(dc, commands.at(j));
+            }
+            i = runEnd;
+        }
+    }
+
+    inline void txLinUnportableFlushCommands(TXTYPE_SDLSURFRENDER* entry) {
+        if (entry == nullptr || entry->renderer == nullptr || entry->commands.empty())
+            return;
+        if (entry->tiled == false || txLinUnportableFlushTiled(entry) == false)
+            txLinUnportableReplayCommands(entry->renderer, entry->commands, 0, entry->commands.size());
+        entry->commands.clear();
+        SDL_SetRenderDrawColor(entry->renderer, txLinUnportableLastDrawColor.r, txLinUnportableLastDrawColor.g, txLinUnportableLastDrawColor.b, 0);
+    }
+
+    inline void txLinUnportableFlushCommands(HDC dc) {
+        txLinUnportableFlushCommands(txLinUnportableFindDCEntry(dc));
+    }
+
+    // offscreen DCs are never presented, so their renderer is flushed right before the surface is touched
+    inline void txLinUnportableSyncSurface(HDC dc) {
+        txLinUnportableFlushCommands(dc);
+#if SDL_VERSION_ATLEAST(2, 0, 10)
+        SDL_RenderFlush(dc);
 #endif
     }
 
-    inline bool txIsFreeBSD() {
-#ifdef __FreeBSD__
-        return true;
+    inline bool txLinUnportableOffMainThread() {
+#ifdef TXLIN_PTHREAD
+        return (pthread_equal(pthread_self(), txLinUnportableMainThread) == 0);
 #else
         return false;
 #endif
     }
 
-    inline bool txLinUnportableFileExists(const char* file) {
-        std::ifstream inputStream(file);
-        return inputStream.good();
+    inline void txLinUnportableQueueCommand(TXTYPE_SDLSURFRENDER* entry, const TXTYPE_DRAWCOMMAND& command) {
+        // everything queued before a clear would be painted over anyway
+        if (command.type == TXLIN_UNPORTABLEDEF_COMMAND_CLEAR)
+            entry->commands.clear();
+        entry->commands.push_back(command);
+        // tiled DCs queue outside of txBegin too, so a long drawing loop is rasterized in large pieces
+        if (entry->tiled && entry->commands.size() >= TXLIN_UNPORTABLEDEF_TILEDBATCH)
+            txLinUnportableFlushCommands(entry);
     }
 
-    inline const char* txLinUnportableFindFont() {
-#ifdef __APPLE__
-        return "/System/Library/Fonts/Apple Symbols.ttf";
-#else
-        std::vector<const char*> fontsList;
-        if (getenv("TXLIN_FONTFILE") != nullptr)
-            fontsList.push_back(getenv("TXLIN_FONTFILE"));
-        fontsList.push_back("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf");
-        fontsList.push_back("/usr/share/fonts/truetype/DejaVuSans.ttf");
-        fontsList.push_back("/usr/share/fonts/dejavu/DejaVuSans.ttf");
-        fontsList.push_back("/usr/share/fonts/TTF/DejaVuSans.ttf");
-        for (int i = 0; i < fontsList.size(); i++) {
-            if (txLinUnportableFileExists(fontsList.at(i))) {
-                txLinUnportableUseMonolithic = false;
-                return fontsList.at(i);
-            }
-        }
-        txLinUnportableUseMonolithic = true;
-        return nullptr;
-#endif
+    // the command buffer a primitive for dc goes to, or nullptr if it should be drawn right away
+    inline TXTYPE_SDLSURFRENDER* txLinUnportableCommandQueueOf(HDC dc) {
+        bool deferred = txLinUnportableDeferredUpdates();
+        if (deferred == false && txLinUnportableTiledDCs == 0)
+            return nullptr;
+        TXTYPE_SDLSURFRENDER* entry = txLinUnportableFindDCEntry(dc);
+        if (entry == nullptr || (deferred == false && entry->tiled == false))
+            return nullptr;
+        return entry;
     }
 
-    inline LOGFONT* txFontExist(const char* name) {
-        if (strcmp("System", name) == 0)
-            return (LOGFONT*)(1);
-        return nullptr;
+#ifdef TXLIN_PTHREAD
+    inline void txLinUnportableRecycleThreadCommands(TXTYPE_THREADCOMMAND* first, TXTYPE_THREADCOMMAND* last) {
+        last->next = txLinUnportableFreeThreadCommands.load(std::memory_order_relaxed);
+        while (txLinUnportableFreeThreadCommands.compare_exchange_weak(last->next, first, std::memory_order_release, std::memory_order_relaxed) == false)
+            continue;
     }
 
-    inline double txSleep(double time = 0) {
-        txRedrawWindow();
-        SDL_Delay(time);
-        return time;
+    // the nodes a thread has taken from the free list but not used yet, given back when the thread exits
+    struct TXTYPE_THREADCOMMANDCACHE {
+        TXTYPE_THREADCOMMAND* nodes = nullptr;
+
+        ~TXTYPE_THREADCOMMANDCACHE() {
+            if (nodes == nullptr)
+                return;
+            TXTYPE_THREADCOMMAND* last = nodes;
+            while (last->next != nullptr)
+                last = last->next;
+            txLinUnportableRecycleThreadCommands(nodes, last);
+        }
+    };
+
+    static thread_local TXTYPE_THREADCOMMANDCACHE txLinUnportableThreadCommandCache;
+
+    // lock-free multi-producer stack: workers push single nodes, the main thread takes the whole chain at once;
+    // nodes are reused, so in a steady animation the workers do not go through the allocator at all
+    inline void txLinUnportablePushThreadCommand(HDC dc, const TXTYPE_DRAWCOMMAND& command) {
+        TXTYPE_THREADCOMMANDCACHE& cache = txLinUnportableThreadCommandCache;
+        if (cache.nodes == nullptr)
+            cache.nodes = txLinUnportableFreeThreadCommands.exchange(nullptr, std::memory_order_acquire);
+        TXTYPE_THREADCOMMAND* node = cache.nodes;
+        if (node != nullptr)
+            cache.nodes = node->next;
+        else
+            node = new TXTYPE_THREADCOMMAND;
+        node->dc = dc;
+        node->command = command;
+        node->next = txLinUnportableThreadCommands.load(std::memory_order_relaxed);
+        while (txLinUnportableThreadCommands.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed) == false)
+            continue;
     }
+#endif
 
-    inline bool txSpeak(const char* stringToSay) {
-        if (stringToSay == nullptr)
-            return false;
-#ifdef __APPLE__
-        bool result = (std::system(std::string("say -v \"" + std::string(TXLIN_MACOS_VOICEOVERVOICE) + "\" '" + std::string(stringToSay) + "'").c_str()) == 0);
-#else
-        bool result = false;
-        if (std::system("command -v festival > /dev/null 2>&1") == 0 && getenv("TXLIN_BROKENFESTIVAL") == nullptr)
-            result = (std::system(std::string("echo '" + std::string(stringToSay) + "' | festival --tts").c_str()) == 0);
-        else if (std::system("command -v espeak > /dev/null 2>&1") == 0)
-            result = (std::system(std::string("espeak '" + std::string(stringToSay) + "'").c_str()) == 0);
-        else
-            TX_ERROR("No TTS engines are installed on your computer. Please install espeak or festival.");
+    // moves the primitives of worker threads into the command buffers of their DCs, in the order they were drawn
+    inline void txLinUnportableDrainThreadCommands() {
+#ifdef TXLIN_PTHREAD
+        TXTYPE_THREADCOMMAND* chain = txLinUnportableThreadCommands.exchange(nullptr, std::memory_order_acquire);
+        TXTYPE_THREADCOMMAND* ordered = nullptr;
+        while (chain != nullptr) {
+            TXTYPE_THREADCOMMAND* next = chain->next;
+            chain->next = ordered;
+            ordered = chain;
+            chain = next;
+        }
+        TXTYPE_THREADCOMMAND* recycled = nullptr;
+        TXTYPE_THREADCOMMAND* recycledLast = ordered;
+        while (ordered != nullptr) {
+            TXTYPE_SDLSURFRENDER* entry = txLinUnportableFindDCEntry(ordered->dc);
+            if (entry != nullptr) {
+                txLinUnportableAddCommandDamage(ordered->dc, ordered->command);
+                txLinUnportableQueueCommand(entry, ordered->command);
+            }
+            TXTYPE_THREADCOMMAND* next = ordered->next;
+            ordered->next = recycled;
+            recycled = ordered;
+            ordered = next;
+        }
+        if (recycled != nullptr)
+            txLinUnportableRecycleThreadCommands(recycled, recycledLast);
 #endif
-        return result;
     }
 
-    inline const char* txCPUVendor() {
-#ifdef __APPLE__
-        if (std::system("test `sysctl machdep.cpu.vendor | cut -d ':' -f2 | sed  's/ //g'` = \"GenuineIntel\"") == 0)
-            return "Intel";
+    inline void txLinUnportableSubmitCommand(HDC dc, int type, COLORREF color, int x0, int y0, int x1 = 0, int y1 = 0) {
+        TXTYPE_DRAWCOMMAND command = { type, (Uint8)(color.r), (Uint8)(color.g), (Uint8)(color.b), x0, y0, x1, y1 };
+        TXLIN_UNPORTABLEDEF_STATPIXELS(txLinUnportableCommandPixels(command));
+#ifdef TXLIN_PTHREAD
+        if (txLinUnportableOffMainThread()) {
+            txLinUnportablePushThreadCommand(dc, command);
+            return;
+        }
+#endif
+        txLinUnportableAddCommandDamage(dc, command);
+        TXTYPE_SDLSURFRENDER* entry = txLinUnportableCommandQueueOf(dc);
+        if (entry == nullptr) {
+            SDL_SetRenderDrawColor(dc, command.r, command.g, command.b, 0);
+            txLinUnportableExecuteCommand(dc, command);
+            SDL_SetRenderDrawColor(dc, txLinUnportableLastDrawColor.r, txLinUnportableLastDrawColor.g, txLinUnportableLastDrawColor.b, 0);
+            return;
+        }
+        txLinUnportableQueueCommand(entry, command);
+    }
+
+    // rectangles (usually 1px high spans) of one color are batched into one SDL call or one queue run
+    inline void txLinUnportableSubmitRects(HDC dc, const std::vector<SDL_Rect>& rects, COLORREF color, bool filled = true) {
+        if (dc == nullptr || rects.empty())
+            return;
+        int type = (filled) ? TXLIN_UNPORTABLEDEF_COMMAND_FILLRECT : TXLIN_UNPORTABLEDEF_COMMAND_RECT;
+#ifdef TXLIN_STATS
+        Uint64 pixels = 0;
+        for (size_t i = 0; i < rects.size(); i++)
+            pixels += (filled) ? (Uint64)(MAX(rects[i].w, 1)) * MAX(rects[i].h, 1) : 2 * (Uint64)(MAX(rects[i].w, 1) + MAX(rects[i].h, 1));
+        txLinUnportableAddStatPixels(pixels);
+#endif
+#ifdef TXLIN_PTHREAD
+        if (txLinUnportableOffMainThread()) {
+            for (size_t i = 0; i < rects.size(); i++) {
+                TXTYPE_DRAWCOMMAND command = { type, (Uint8)(color.r), (Uint8)(color.g), (Uint8)(color.b), rects[i].x, rects[i].y, rects[i].x + rects[i].w, rects[i].y + rects[i].h };
+                txLinUnportablePushThreadCommand(dc, command);
+            }
+            return;
+        }
+#endif
+        if (dc == txLinUnportableContext.renderer) {
+            int left = rects[0].x;
+            int top = rects[0].y;
+            int right = rects[0].x + MAX(rects[0].w, 1);
+            int bottom = rects[0].y + MAX(rects[0].h, 1);
+            for (size_t i = 1; i < rects.size(); i++) {
+                left = MIN(left, rects[i].x);
+                top = MIN(top, rects[i].y);
+                right = MAX(right, rects[i].x + MAX(rects[i].w, 1));
+                bottom = MAX(bottom, rects[i].y + MAX(rects[i].h, 1));
+            }
+            txLinUnportableAddDamage(dc, left, top, right - left, bottom - top);
+        }
+        TXTYPE_SDLSURFRENDER* entry = txLinUnportableCommandQueueOf(dc);
+        if (entry == nullptr) {
+            SDL_SetRenderDrawColor(dc, (Uint8)(color.r), (Uint8)(color.g), (Uint8)(color.b), 0);
+            if (filled)
+                SDL_RenderFillRects(dc, &(rects[0]), (int)(rects.size()));
+            else
+                SDL_RenderDrawRects(dc, &(rects[0]), (int)(rects.size()));
+            SDL_SetRenderDrawColor(dc, txLinUnportableLastDrawColor.r, txLinUnportableLastDrawColor.g, txLinUnportableLastDrawColor.b, 0);
+            return;
+        }
+        for (size_t i = 0; i < rects.size(); i++) {
+            TXTYPE_DRAWCOMMAND command = { type, (Uint8)(color.r), (Uint8)(color.g), (Uint8)(color.b), rects[i].x, rects[i].y, rects[i].x + rects[i].w, rects[i].y + rects[i].h };
+            txLinUnportableQueueCommand(entry, command);
+        }
+    }
+
+    inline void txLinUnportableAddSpan(std::vector<SDL_Rect>& spans, int x0, int x1, int y) {
+        if (x1 < x0)
+            return;
+        SDL_Rect span = { x0, y, x1 - x0 + 1, 1 };
+        spans.push_back(span);
+    }
+
+#ifdef TXLIN_STATS
+    // draws the last frame's counters over the top left corner of surface; the pixels under it are saved into backup
+    inline bool txLinUnportableDrawStatsOverlay(SDL_Surface* surface, std::vector<Uint8>& backup) {
+        SDL_Rect& area = txLinUnportableStatsOverlayArea;
+        area.w = 0;
+        area.h = 0;
+        if (txLinUnportableStatsOverlay == false || surface == nullptr || surface->pixels == nullptr)
+            return false;
+        std::vector<std::string> lines;
+        char line[64];
+        snprintf(line, sizeof(line), "%-10s%6s%10s%8s", "", "CALLS", "PIXELS", "MS");
+        lines.push_back(line);
+        for (int i = 0; i < TX_STAT_COUNT; i++) {
+            if (txLinUnportableLastStats[i].calls == 0)
+                continue;
+            snprintf(line, sizeof(line), "%-10s%6lu%10lu%8.2f", txLinUnportableStatNames[i], txLinUnportableLastStats[i].calls, txLinUnportableLastStats[i].pixels, txLinUnportableLastStats[i].time);
+            lines.push_back(line);
+        }
+        area.x = 4;
+        area.y = 4;
+        area.w = MIN((int)(lines[0].size()) * 4 + 3, surface->w - area.x);
+        area.h = MIN((int)(lines.size()) * 6 + 3, surface->h - area.y);
+        if (area.w <= 0 || area.h <= 0)
+            return false;
+        if (SDL_MUSTLOCK(surface) && SDL_LockSurface(surface) != 0)
+            return false;
+        int bpp = surface->format->BytesPerPixel;
+        backup.resize((size_t)(area.w) * area.h * bpp);
+        for (int y = 0; y < area.h; y++)
+            memcpy(&(backup[(size_t)(y) * area.w * bpp]), (Uint8*)(surface->pixels) + (area.y + y) * surface->pitch + area.x * bpp, area.w * bpp);
+        if (SDL_MUSTLOCK(surface))
+            SDL_UnlockSurface(surface);
+        std::vector<SDL_Rect> dots;
+        for (size_t row = 0; row < lines.size(); row++) {
+            for (size_t column = 0; column < lines[row].size(); column++) {
+                const char* glyph = strchr(TXLIN_UNPORTABLEDEF_STATSFONT, lines[row][column]);
+                if (lines[row][column] == ' ' || glyph == nullptr)
+                    continue;
+                unsigned short bits = txLinUnportableStatsGlyphs[glyph - TXLIN_UNPORTABLEDEF_STATSFONT];
+                for (int bit = 0; bit < 15; bit++) {
+                    if ((bits & (0x4000 >> bit)) == 0)
+                        continue;
+                    SDL_Rect dot = { area.x + 2 + (int)(column) * 4 + bit % 3, area.y + 2 + (int)(row) * 6 + bit / 3, 1, 1 };
+                    if (dot.x < area.x + area.w && dot.y < area.y + area.h)
+                        dots.push_back(dot);
+                }
+            }
+        }
+        SDL_FillRect(surface, &area, SDL_MapRGB(surface->format, 0, 0, 0));
+        if (dots.empty() == false)
+            SDL_FillRects(surface, &(dots[0]), (int)(dots.size()), SDL_MapRGB(surface->format, 0, 255, 128));
+        return true;
+    }
+
+    inline void txLinUnportableRestoreStatsOverlay(SDL_Surface* surface, const std::vector<Uint8>& backup) {
+        const SDL_Rect& area = txLinUnportableStatsOverlayArea;
+        if (SDL_MUSTLOCK(surface) && SDL_LockSurface(surface) != 0)
+            return;
+        int bpp = surface->format->BytesPerPixel;
+        for (int y = 0; y < area.h; y++)
+            memcpy((Uint8*)(surface->pixels) + (area.y + y) * surface->pitch + area.x * bpp, &(backup[(size_t)(y) * area.w * bpp]), area.w * bpp);
+        if (SDL_MUSTLOCK(surface))
+            SDL_UnlockSurface(surface);
+    }
+#endif
+
+    // the frame slot of the recording that is on now, counted from txStartRecording at the recording's FPS
+    inline Uint64 txLinUnportableRecordSlot(TXTYPE_RECORDER* recorder) {
+        Uint64 elapsed = txGetTimeNs() - recorder->start;
+        // frames elapsed times the denominator, divided once so fractional rates do not lag behind
+        Uint64 scaled = (elapsed / 1000000000ULL) * recorder->fpsNumerator + (elapsed % 1000000000ULL) * recorder->fpsNumerator / 1000000000ULL;
+        return scaled / recorder->fpsDenominator;
+    }
+
+    // Y4M frames are planar YUV 4:2:0 (full range BT.601, chroma of 2x2 blocks), raw ones are packed RGB
+    inline bool txLinUnportableWriteRecordFrame(TXTYPE_RECORDER* recorder, const TXTYPE_RECORDFRAME& frame) {
+        int w = recorder->width;
+        int h = recorder->height;
+        const int* shifts = recorder->shifts;
+        const Uint32* pixels = &(frame.pixels[0]);
+        std::vector<Uint8>& output = recorder->output;
+        if (recorder->y4m) {
+            int chromaWidth = (w + 1) / 2;
+            int chromaHeight = (h + 1) / 2;
+            output.resize(6 + (size_t)(w) * h + 2 * (size_t)(chromaWidth) * chromaHeight);
+            memcpy(&(output[0]), "FRAME\n", 6);
+            Uint8* luma = &(output[6]);
+            Uint8* blue = luma + (size_t)(w) * h;
+            Uint8* red = blue + (size_t)(chromaWidth) * chromaHeight;
+            for (size_t i = 0; i < (size_t)(w) * h; i++) {
+                int r = (pixels[i] >> shifts[0]) & 0xFF;
+                int g = (pixels[i] >> shifts[1]) & 0xFF;
+                int b = (pixels[i] >> shifts[2]) & 0xFF;
+                luma[i] = (Uint8)((77 * r + 150 * g + 29 * b + 128) >> 8);
+            }
+            for (int cy = 0; cy < chromaHeight; cy++) {
+                for (int cx = 0; cx < chromaWidth; cx++) {
+                    int r = 0;
+                    int g = 0;
+                    int b = 0;
+                    int count = 0;
+                    for (int y = cy * 2; y < MIN(cy * 2 + 2, h); y++) {
+                        for (int x = cx * 2; x < MIN(cx * 2 + 2, w); x++) {
+                            Uint32 pixel = pixels[(size_t)(y) * w + x];
+                            r += (pixel >> shifts[0]) & 0xFF;
+                            g += (pixel >> shifts[1]) & 0xFF;
+                            b += (pixel >> shifts[2]) & 0xFF;
+                            count++;
+                        }
+                    }
+                    r /= count;
+                    g /= count;
+                    b /= count;
+                    blue[(size_t)(cy) * chromaWidth + cx] = (Uint8)(MIN(255, 128 + ((-43 * r - 85 * g + 128 * b + 128) >> 8)));
+                    red[(size_t)(cy) * chromaWidth + cx] = (Uint8)(MIN(255, 128 + ((128 * r - 107 * g - 21 * b + 128) >> 8)));
+                }
+            }
+        }
+        else {
+            output.resize((size_t)(w) * h * 3);
+            for (size_t i = 0; i < (size_t)(w) * h; i++) {
+                output[i * 3] = (Uint8)(pixels[i] >> shifts[0]);
+                output[i * 3 + 1] = (Uint8)(pixels[i] >> shifts[1]);
+                output[i * 3 + 2] = (Uint8)(pixels[i] >> shifts[2]);
+            }
+        }
+        for (Uint64 i = 0; i < frame.repeat; i++) {
+            if (fwrite(&(output[0]), 1, output.size(), recorder->file) != output.size())
+                return false;
+        }
+        return true;
+    }
+
+#ifdef TXLIN_PTHREAD
+    inline void* txLinUnportableRecorderWriter(void* param) {
+        TXTYPE_RECORDER* recorder = (TXTYPE_RECORDER*)(param);
+        pthread_mutex_lock(&(recorder->mutex));
+        while (true) {
+            while (recorder->readyBuffers.empty() && recorder->stopping == false)
+                pthread_cond_wait(&(recorder->condition), &(recorder->mutex));
+            if (recorder->readyBuffers.empty())
+                break;
+            int index = recorder->readyBuffers.front();
+            recorder->readyBuffers.erase(recorder->readyBuffers.begin());
+            bool failed = recorder->failed;
+            // the disk is only touched with the lock released, so the main thread can keep handing out buffers
+            pthread_mutex_unlock(&(recorder->mutex));
+            bool written = (failed == false && txLinUnportableWriteRecordFrame(recorder, recorder->buffers[index]));
+            pthread_mutex_lock(&(recorder->mutex));
+            if (written)
+                recorder->written += (unsigned long)(recorder->buffers[index].repeat);
+            else
+                recorder->failed = true;
+            recorder->freeBuffers.push_back(index);
+            pthread_cond_broadcast(&(recorder->condition));
+        }
+        pthread_mutex_unlock(&(recorder->mutex));
+        return nullptr;
+    }
+#endif
+
+    // hands a filled buffer to the writer thread; without TXLIN_PTHREAD it is written right away
+    inline void txLinUnportableSubmitRecordFrame(TXTYPE_RECORDER* recorder, int index) {
+#ifdef TXLIN_PTHREAD
+        pthread_mutex_lock(&(recorder->mutex));
+        recorder->readyBuffers.push_back(index);
+        pthread_cond_broadcast(&(recorder->condition));
+        pthread_mutex_unlock(&(recorder->mutex));
+#else
+        if (recorder->failed == false && txLinUnportableWriteRecordFrame(recorder, recorder->buffers[index]))
+            recorder->written += (unsigned long)(recorder->buffers[index].repeat);
+        else
+            recorder->failed = true;
+        recorder->freeBuffers.push_back(index);
+#endif
+    }
+
+    // a free buffer for the next frame, or -1 when the writer is behind and the frame has to be dropped
+    inline int txLinUnportableAcquireRecordBuffer(TXTYPE_RECORDER* recorder) {
+        int index = -1;
+#ifdef TXLIN_PTHREAD
+        pthread_mutex_lock(&(recorder->mutex));
+        while (recorder->freeBuffers.empty() && (recorder->flags & TX_RECORD_BLOCK) != 0)
+            pthread_cond_wait(&(recorder->condition), &(recorder->mutex));
+#endif
+        if (recorder->freeBuffers.empty() == false) {
+            index = recorder->freeBuffers.back();
+            recorder->freeBuffers.pop_back();
+        }
+#ifdef TXLIN_PTHREAD
+        pthread_mutex_unlock(&(recorder->mutex));
+#endif
+        return index;
+    }
+
+    inline bool txStopRecording() {
+        TXTYPE_RECORDER* recorder = txLinUnportableRecorder;
+        if (recorder == nullptr)
+            return false;
+        txLinUnportableRecorder = nullptr;
+        // the last copy stayed on the screen until now
+        if (recorder->pending >= 0) {
+            Uint64 slot = txLinUnportableRecordSlot(recorder);
+            bool everyFrame = ((recorder->flags & TX_RECORD_EVERYFRAME) != 0);
+            recorder->buffers[recorder->pending].repeat = (everyFrame || slot <= recorder->pendingSlot) ? 1 : slot - recorder->pendingSlot;
+            txLinUnportableSubmitRecordFrame(recorder, recorder->pending);
+        }
+#ifdef TXLIN_PTHREAD
+        pthread_mutex_lock(&(recorder->mutex));
+        recorder->stopping = true;
+        pthread_cond_broadcast(&(recorder->condition));
+        pthread_mutex_unlock(&(recorder->mutex));
+        pthread_join(recorder->writer, nullptr);
+        pthread_mutex_destroy(&(recorder->mutex));
+        pthread_cond_destroy(&(recorder->condition));
+#endif
+        bool result = (fclose(recorder->file) == 0 && recorder->failed == false);
+        if (result == false)
+            TXLIN_WARNING("the recording could not be written completely, the disk may be full");
+        DBGOUT << "Recording stopped: " << recorder->written << " frames written, " << recorder->dropped << " dropped" << std::endl;
+        txLinUnportableRecorderDropped = recorder->dropped;
+        delete recorder;
+        return result;
+    }
+
+    inline void txLinUnportableStopRecordingAtExit() {
+        txStopRecording();
+    }
+
+    // copies the canvas into the recording once per frame slot, or on every call with TX_RECORD_EVERYFRAME
+    inline void txLinUnportableRecordFrame(SDL_Surface* surface) {
+        TXTYPE_RECORDER* recorder = txLinUnportableRecorder;
+        if (recorder == nullptr || surface == nullptr || surface->pixels == nullptr)
+            return;
+        if (surface->format->format != recorder->format) {
+            TXLIN_WARNING("the window has changed its pixel format, the recording is stopped");
+            txStopRecording();
+            return;
+        }
+        bool everyFrame = ((recorder->flags & TX_RECORD_EVERYFRAME) != 0);
+        Uint64 slot = (everyFrame) ? 0 : txLinUnportableRecordSlot(recorder);
+        if (everyFrame == false && recorder->pending >= 0 && slot <= recorder->pendingSlot)
+            return;
+        if (SDL_MUSTLOCK(surface) && SDL_LockSurface(surface) != 0)
+            return;
+        int index = txLinUnportableAcquireRecordBuffer(recorder);
+        if (index < 0) {
+            if (SDL_MUSTLOCK(surface))
+                SDL_UnlockSurface(surface);
+            // the frame on the screen is kept for longer instead, so the video still lasts as long as the program ran
+            if (everyFrame || slot != recorder->droppedSlot)
+                recorder->dropped++;
+            recorder->droppedSlot = slot;
+            return;
+        }
+        TXTYPE_RECORDFRAME& frame = recorder->buffers[index];
+        int w = MIN(surface->w, recorder->width);
+        int h = MIN(surface->h, recorder->height);
+        if (w < recorder->width || h < recorder->height)
+            std::fill(frame.pixels.begin(), frame.pixels.end(), 0);
+        for (int y = 0; y < h; y++)
+            memcpy(&(frame.pixels[(size_t)(y) * recorder->width]), (Uint8*)(surface->pixels) + (size_t)(y) * surface->pitch, (size_t)(w) * 4);
+        if (SDL_MUSTLOCK(surface))
+            SDL_UnlockSurface(surface);
+        if (recorder->pending >= 0) {
+            recorder->buffers[recorder->pending].repeat = (everyFrame) ? 1 : slot - recorder->pendingSlot;
+            txLinUnportableSubmitRecordFrame(recorder, recorder->pending);
+        }
+        recorder->pending = index;
+        recorder->pendingSlot = slot;
+    }
+
+    inline void txRedrawWindow(bool mtFunc = false) {
+        // only the main thread may talk to SDL, it presents whatever the workers queued next time it gets here
+        if (txLinUnportableOffMainThread())
+            return;
+        // a locked canvas may hold a half-drawn frame, so it stays off the screen until the last txUnlock
+        if (txLinUnportableHeldLocks > 0) {
+            if (mtFunc == false)
+                txLinUnportableSDLProcessEvents();
+            return;
+        }
+        TXLIN_UNPORTABLEDEF_STATSCOPE(TX_STAT_PRESENT);
+        txLinUnportableDrainThreadCommands();
+        TXTYPE_DCCONTEXT* context = txLinUnportableCurrentContext();
+        for (int i = 0; i < txLinUnportableDCSurfaces.size(); i++) {
+            if (txLinUnportableDCSurfaces.at(i).renderer == nullptr || txLinUnportableDCSurfaces.at(i).offscreen)
+                continue;
+            if (mtFunc == false)
+                txLinUnportableFlushCommands(&(txLinUnportableDCSurfaces[i]));
+            // presenting a software renderer copies its whole window to the screen, the damaged parts are sent below instead
+            if (txLinUnportableDCSurfaces.at(i).renderer == context->renderer && context->softwareRenderer) {
+#if SDL_VERSION_ATLEAST(2, 0, 10)
+                SDL_RenderFlush(context->renderer);
+#endif
+                continue;
+            }
+            SDL_RenderPresent(txLinUnportableDCSurfaces.at(i).renderer);
+        }
+        txLinUnportableRecordFrame(context->surface);
+        if (txLinUnportableHeadless == false && context->window != nullptr) {
+#ifdef TXLIN_STATS
+            // the overlay is only put on the screen, the canvas under it is restored right after the update
+            SDL_Rect oldOverlay = txLinUnportableStatsOverlayArea;
+            std::vector<Uint8> overlayBackup;
+            bool overlay = txLinUnportableDrawStatsOverlay(context->surface, overlayBackup);
+            txLinUnportableAddDamage(context->renderer, oldOverlay.x, oldOverlay.y, oldOverlay.w, oldOverlay.h);
+            txLinUnportableAddDamage(context->renderer, txLinUnportableStatsOverlayArea.x, txLinUnportableStatsOverlayArea.y, txLinUnportableStatsOverlayArea.w, txLinUnportableStatsOverlayArea.h);
+#endif
+            if (txLinUnportableFullDamage || context->softwareRenderer == false)
+                SDL_UpdateWindowSurface(context->window);
+            else if (txLinUnportableDamage.empty() == false)
+                SDL_UpdateWindowSurfaceRects(context->window, &(txLinUnportableDamage[0]), (int)(txLinUnportableDamage.size()));
+#ifdef TXLIN_STATS
+            if (overlay)
+                txLinUnportableRestoreStatsOverlay(context->surface, overlayBackup);
+#endif
+        }
+        txLinUnportableDamage.clear();
+        txLinUnportableFullDamage = false;
+        if (mtFunc == false)
+            txLinUnportableSDLProcessEvents();
+    }
+
+    inline void txLinUnportableCommitDrawing() {
+        if (txLinUnportableDeferredUpdates() == false)
+            txRedrawWindow();
+    }
+
+    inline bool txFlush() {
+        txRedrawWindow();
+        return true;
+    }
+
+    inline bool txSetHeadless(bool value = true) {
+        txLinUnportableHeadless = value;
+        return txLinUnportableHeadless;
+    }
+
+    inline bool txIsHeadless() {
+        return txLinUnportableHeadless;
+    }
+
+    inline void txLinUnportableDestroyHeadlessCanvas() {
+        if (txLinUnportableHeadlessContext.renderer == nullptr)
+            return;
+        txLinUnportableUnregisterDC(txLinUnportableHeadlessContext.renderer);
+        SDL_DestroyRenderer(txLinUnportableHeadlessContext.renderer);
+        SDL_FreeSurface(txLinUnportableHeadlessContext.surface);
+        txLinUnportableHeadlessContext.renderer = nullptr;
+        txLinUnportableHeadlessContext.surface = nullptr;
+        txLinUnportableInvalidateContext();
+    }
+
+    inline HWND txLinUnportableCreateHeadlessCanvas(int width, int height) {
+        txLinUnportableDestroyHeadlessCanvas();
+        // same layout as a typical window surface, so blits and saved images do not depend on the mode
+        SDL_Surface* canvas = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGB888);
+        if (canvas == nullptr) {
+            TXLIN_WARNING("SDL_GetError() reports: " + std::string(SDL_GetError()) + ", cannot create the headless canvas");
+            return -1;
+        }
+        SDL_Renderer* canvasRenderer = SDL_CreateSoftwareRenderer(canvas);
+        if (canvasRenderer == nullptr) {
+            TXLIN_WARNING("SDL_GetError() reports: " + std::string(SDL_GetError()) + ", cannot create the headless canvas");
+            SDL_FreeSurface(canvas);
+            return -1;
+        }
+        txLinUnportableHeadlessContext.windowId++;
+        txLinUnportableHeadlessContext.renderer = canvasRenderer;
+        txLinUnportableHeadlessContext.surface = canvas;
+        txLinUnportableRecentlyCreatedWindow = txLinUnportableHeadlessContext.windowId;
+        txLinUnportableContext = txLinUnportableHeadlessContext;
+        txLinUnportableRegisterDC(canvas, canvasRenderer, false);
+        txSetDefaults(canvasRenderer);
+        txSetFillColor(TX_BLACK);
+        txClear(canvasRenderer);
+        DBGOUT << "Headless canvas created" << std::endl;
+        return txLinUnportableRecentlyCreatedWindow;
+    }
+
+    inline HWND txCreateWindow(double sizeX, double sizeY, bool centered = true) {
+        if (getenv("TXLIN_HEADLESS") != nullptr && strcmp(getenv("TXLIN_HEADLESS"), "0") != 0)
+            txLinUnportableHeadless = true;
+        if (txLinUnportableHasInitializedTXLinInThisContext == false && txLinUnportableInitSDL() == false)
+            return -1;
+        if (txLinUnportableHeadless)
+            return txLinUnportableCreateHeadlessCanvas((int)(sizeX), (int)(sizeY));
+        int x = SDL_WINDOWPOS_CENTERED;
+        int y = SDL_WINDOWPOS_CENTERED;
+        if (centered == false) {
+            x = 2;
+            y = 2;
+        }
+        SDL_Window* window = SDL_CreateWindow("TXLin", x, y, (int)(sizeX), (int)(sizeY), SDL_WINDOW_SHOWN);
+        txLinUnportableRecentlyCreatedWindow = SDL_GetWindowID(window);
+        txSetFillColor(TX_BLACK);
+        txClear(txDC());
+        SDL_UpdateWindowSurface(window);
+        txLinUnportableRegisterDC(SDL_GetWindowSurface(window), SDL_GetRenderer(window), false);
+        SDL_ShowWindow(window);
+        SDL_RaiseWindow(window);
+        SDL_Delay(500);
+        DBGOUT << "Window shown" << std::endl;
+        return txLinUnportableRecentlyCreatedWindow;
+    }
+
+    inline bool txIsLinux() {
+#ifdef __linux__
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    inline bool txIsMacOS() {
+#ifdef __APPLE__
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    inline bool txIsFreeBSD() {
+#ifdef __FreeBSD__
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    inline bool txLinUnportableFileExists(const char* file) {
+        std::ifstream inputStream(file);
+        return inputStream.good();
+    }
+
+    inline const char* txLinUnportableFindFont() {
+#ifdef __APPLE__
+        return "/System/Library/Fonts/Apple Symbols.ttf";
+#else
+        // the lookup hits the file system, so it is done once
+        static bool searched = false;
+        static const char* foundFont = nullptr;
+        if (searched) {
+            txLinUnportableUseMonolithic = (foundFont == nullptr);
+            return foundFont;
+        }
+        searched = true;
+        std::vector<const char*> fontsList;
+        if (getenv("TXLIN_FONTFILE") != nullptr)
+            fontsList.push_back(getenv("TXLIN_FONTFILE"));
+        fontsList.push_back("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf");
+        fontsList.push_back("/usr/share/fonts/truetype/DejaVuSans.ttf");
+        fontsList.push_back("/usr/share/fonts/dejavu/DejaVuSans.ttf");
+        fontsList.push_back("/usr/share/fonts/TTF/DejaVuSans.ttf");
+        for (int i = 0; i < fontsList.size(); i++) {
+            if (txLinUnportableFileExists(fontsList.at(i))) {
+                txLinUnportableUseMonolithic = false;
+                foundFont = fontsList.at(i);
+                return foundFont;
+            }
+        }
+        txLinUnportableUseMonolithic = true;
+        return nullptr;
+#endif
+    }
+
+    inline LOGFONT* txFontExist(const char* name) {
+        if (strcmp("System", name) == 0)
+            return (LOGFONT*)(1);
+        return nullptr;
+    }
+
+    inline double txSleep(double time = 0) {
+        txRedrawWindow();
+        txLinUnportableStatsEndFrame();
+        SDL_Delay(time);
+        return time;
+    }
+
+    inline bool txSpeak(const char* stringToSay) {
+        if (stringToSay == nullptr)
+            return false;
+#ifdef __APPLE__
+        bool result = (std::system(std::string("say -v \"" + std::string(TXLIN_MACOS_VOICEOVERVOICE) + "\" '" + std::string(stringToSay) + "'").c_str()) == 0);
+#else
+        bool result = false;
+        if (std::system("command -v festival > /dev/null 2>&1") == 0 && getenv("TXLIN_BROKENFESTIVAL") == nullptr)
+            result = (std::system(std::string("echo '" + std::string(stringToSay) + "' | festival --tts").c_str()) == 0);
+        else if (std::system("command -v espeak > /dev/null 2>&1") == 0)
+            result = (std::system(std::string("espeak '" + std::string(stringToSay) + "'").c_str()) == 0);
+        else
+            TX_ERROR("No TTS engines are installed on your computer. Please install espeak or festival.");
+#endif
+        return result;
+    }
+
+    inline const char* txCPUVendor() {
+#ifdef __APPLE__
+        if (std::system("test `sysctl machdep.cpu.vendor | cut -d ':' -f2 | sed  's/ //g'` = \"GenuineIntel\"") == 0)
+            return "Intel";
         else if (std::system("test `sysctl machdep.cpu.vendor | cut -d ':' -f2 | sed  's/ //g'` = \"AuthenticAMD\"") == 0)
             return "AMD";
         else if (std::system("test `sysctl machdep.cpu.vendor | cut -d ':' -f2 | sed  's/ //g'` = \" lrpepyh vr\"") == 0)
@@ -776,7 +2058,7 @@ namespace TX {
 
     #define GetDC(hwndIn) SDL_GetRenderer(SDL_GetWindowFromID(hwndIn))
     #define GetForegroundWindow() txWindow()
-    #define ReleaseDC(hwndIn, hdcIn) { (void)(hwndIn); SDL_DestroyRenderer(hdcIn); }
+    #define ReleaseDC(hwndIn, hdcIn) { (void)(hwndIn); txLinUnportableInvalidateContext(); SDL_DestroyRenderer(hdcIn); }
 
     inline bool SetForegroundWindow(HWND hwndIn = txWindow()) {
         SDL_Window* window = SDL_GetWindowFromID(hwndIn);
@@ -788,12 +2070,22 @@ namespace TX {
 
 
 
-    HDC txDC() {
-        DBGOUT << "called txDC()" << std::endl;
+    TXTYPE_DCCONTEXT* txLinUnportableCurrentContext() {
+        if (txLinUnportableContext.renderer != nullptr && txLinUnportableContext.windowId == txLinUnportableRecentlyCreatedWindow)
+            return &txLinUnportableContext;
+        if (txLinUnportableOffMainThread())
+            return &txLinUnportableContext;
+        DBGOUT << "resolving the drawing context" << std::endl;
+        if (txLinUnportableHeadless && txLinUnportableHeadlessContext.renderer != nullptr) {
+            txLinUnportableContext = txLinUnportableHeadlessContext;
+            return &txLinUnportableContext;
+        }
+        txLinUnportableInvalidateContext();
         SDL_Window* window = SDL_GetWindowFromID(txWindow());
         if (window == nullptr)
-            return nullptr;
+            return &txLinUnportableContext;
         SDL_Renderer* resultRenderer = SDL_GetRenderer(window);
+        bool regenerated = false;
         if (resultRenderer == nullptr) {
             DBGOUT << "regenerating renderer" << std::endl;
     #ifndef TXLIN_NO_3D_ACCELERATION
@@ -801,17 +2093,46 @@ namespace TX {
     #else
             resultRenderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE);
     #endif
+            regenerated = true;
+        }
+        // cache before txSetDefaults, which asks for txDC() again
+        txLinUnportableContext.windowId = txLinUnportableRecentlyCreatedWindow;
+        txLinUnportableContext.window = window;
+        txLinUnportableContext.renderer = resultRenderer;
+        txLinUnportableContext.surface = SDL_GetWindowSurface(window);
+        SDL_RendererInfo rendererInfo;
+        txLinUnportableContext.softwareRenderer = (resultRenderer != nullptr && SDL_GetRendererInfo(resultRenderer, &rendererInfo) == 0 && (rendererInfo.flags & SDL_RENDERER_SOFTWARE) != 0);
+        if (regenerated && resultRenderer != nullptr) {
             txSetDefaults(resultRenderer);
             txRedrawWindow();
-            //txSetDefaults(resultRenderer);
         }
-        return resultRenderer;
+        return &txLinUnportableContext;
+    }
+
+    HDC txDC() {
+        return txLinUnportableCurrentContext()->renderer;
+    }
+
+    inline SDL_Surface* txLinUnportableSurfaceOf(HDC dc) {
+        TXTYPE_DCCONTEXT* context = txLinUnportableCurrentContext();
+        if (dc == context->renderer)
+            return context->surface;
+        TXTYPE_SDLSURFRENDER* entry = txLinUnportableFindDCEntry(dc);
+        if (entry != nullptr && entry->surface != nullptr)
+            return entry->surface;
+        return context->surface;
     }
 
     inline RGBQUAD* txVideoMemory(HDC dc = txDC()) {
         if (dc == nullptr)
             return nullptr;
-        return (RGBQUAD*)(SDL_GetWindowSurface(SDL_GetWindowFromID(txWindow()))->pixels);
+        txLinUnportableSyncSurface(dc);
+        SDL_Surface* surface = txLinUnportableSurfaceOf(dc);
+        if (surface == nullptr)
+            return nullptr;
+        // the program may change any pixel through this pointer
+        txLinUnportableDamageAll(dc);
+        return (RGBQUAD*)(surface->pixels);
     }
 
     inline bool txOK() {
@@ -824,6 +2145,11 @@ namespace TX {
         result.y = 0.0;
         int xSet = 0;
         int ySet = 0;
+        if (dc != nullptr && dc == txLinUnportableContext.renderer && txLinUnportableContext.surface != nullptr) {
+            result.x = (double)(txLinUnportableContext.surface->w);
+            result.y = (double)(txLinUnportableContext.surface->h);
+            return result;
+        }
         if (SDL_GetRendererOutputSize(dc, &xSet, &ySet) != 0)
             return result;
         result.x = (double)(xSet);
@@ -865,7 +2191,7 @@ namespace TX {
     inline const char* txGetModuleFileName (bool fileNameOnly = true) {
         if (fileNameOnly)
             return nullptr;
-        return SDL_GetWindowTitle(SDL_GetWindowFromID(txWindow()));
+        return SDL_GetWindowTitle(txLinUnportableCurrentContext()->window);
     }
 
     COLORREF RGB (int red, int green, int blue) {
@@ -880,7 +2206,8 @@ namespace TX {
         txLinUnportableLastDrawColor.r = color.r;
         txLinUnportableLastDrawColor.g = color.g;
         txLinUnportableLastDrawColor.b = color.b;
-        SDL_SetRenderDrawColor(rendererContext, color.r, color.g, color.b, 0);
+        if (txLinUnportableOffMainThread() == false)
+            SDL_SetRenderDrawColor(rendererContext, color.r, color.g, color.b, 0);
         txLinUnportableLineThickness = thickness;
         return rendererContext;
     }
@@ -921,24 +2248,19 @@ namespace TX {
     bool txClear (HDC dc) {
         if (dc == nullptr)
             return false;
-        COLORREF oldC = txGetColor();
-        txSetColor(txGetFillColor());
-        SDL_RenderClear(dc);
-        txSetColor(oldC);
-        if (txLinUnportableAutomaticWindowUpdates)
-            txRedrawWindow();
+        TXLIN_UNPORTABLEDEF_STATSCOPE(TX_STAT_CLEAR);
+        TXLIN_UNPORTABLEDEF_STATPIXELS((Uint64)(txGetExtentX(dc)) * txGetExtentY(dc));
+        txLinUnportableSubmitCommand(dc, TXLIN_UNPORTABLEDEF_COMMAND_CLEAR, txGetFillColor(), 0, 0);
+        txLinUnportableCommitDrawing();
         return true;
     }
 
     inline bool txSetPixel_e (double x, double y, COLORREF color = txGetColor(), HDC dc = txDC()) {
         if (dc == nullptr)
             return false;
-        COLORREF legacyColor = txLinUnportableLastDrawColor;
-        SDL_SetRenderDrawColor(dc, color.r, color.g, color.b, 0);
-        SDL_RenderDrawPoint(dc, (int)(x), (int)(y));
-        SDL_SetRenderDrawColor(dc, legacyColor.r, legacyColor.g, legacyColor.b, 0);
-        if (txLinUnportableAutomaticWindowUpdates)
-            txRedrawWindow();
+        TXLIN_UNPORTABLEDEF_STATSCOPE(TX_STAT_SETPIXEL);
+        txLinUnportableSubmitCommand(dc, TXLIN_UNPORTABLEDEF_COMMAND_POINT, color, (int)(x), (int)(y));
+        txLinUnportableCommitDrawing();
         return true;
     }
 
@@ -978,13 +2300,75 @@ namespace TX {
         }
     }
 
+    inline void txLinUnportablePutPixel(SDL_Surface* surface, int x, int y, Uint32 pixel) {
+        int bpp = surface->format->BytesPerPixel;
+        Uint8 *p = (Uint8 *)surface->pixels + y * surface->pitch + x * bpp;
+
+        switch(bpp) {
+        case 1:
+            *p = (Uint8)(pixel);
+            break;
+
+        case 2:
+            *(Uint16 *)p = (Uint16)(pixel);
+            break;
+
+        case 3:
+            if(SDL_BYTEORDER == SDL_BIG_ENDIAN) {
+                p[0] = (pixel >> 16) & 0xff;
+                p[1] = (pixel >> 8) & 0xff;
+                p[2] = pixel & 0xff;
+            }
+            else {
+                p[0] = pixel & 0xff;
+                p[1] = (pixel >> 8) & 0xff;
+                p[2] = (pixel >> 16) & 0xff;
+            }
+            break;
+
+        case 4:
+            *(Uint32 *)p = pixel;
+            break;
+        }
+    }
+
+    // makes everything drawn through the renderer visible in the surface and locks it for direct access
+    inline SDL_Surface* txLinUnportableLockSurface(HDC dc) {
+        if (dc == nullptr)
+            return nullptr;
+        txLinUnportableSyncSurface(dc);
+        SDL_Surface* surface = txLinUnportableSurfaceOf(dc);
+        if (surface == nullptr || surface->pixels == nullptr)
+            return nullptr;
+        if (SDL_MUSTLOCK(surface) && SDL_LockSurface(surface) != 0)
+            return nullptr;
+        return surface;
+    }
+
+    inline void txLinUnportableUnlockSurface(SDL_Surface* surface) {
+        if (surface != nullptr && SDL_MUSTLOCK(surface))
+            SDL_UnlockSurface(surface);
+    }
+
+    inline Uint32 txLinUnportableMapColor(SDL_Surface* surface, COLORREF color) {
+        return SDL_MapRGB(surface->format, (Uint8)(color.r), (Uint8)(color.g), (Uint8)(color.b));
+    }
+
     inline COLORREF txGetPixel (double x, double y, HDC dc = txDC()) {
         COLORREF result = { 255, 255, 255 };
         if (dc == nullptr)
             return result;
-        SDL_Window* window = SDL_GetWindowFromID(txWindow());
-        SDL_Surface* wSurface = SDL_GetWindowSurface(window);
+        TXLIN_UNPORTABLEDEF_STATSCOPE(TX_STAT_GETPIXEL);
+        TXLIN_UNPORTABLEDEF_STATPIXELS(1);
+        SDL_Surface* wSurface = txLinUnportableLockSurface(dc);
+        if (wSurface == nullptr)
+            return result;
+        if (x < 0 || y < 0 || x >= wSurface->w || y >= wSurface->h) {
+            txLinUnportableUnlockSurface(wSurface);
+            return result;
+        }
         Uint32 pixelRaw = txLinUnportableGetPixel(wSurface, (int)(x), (int)(y));
+        txLinUnportableUnlockSurface(wSurface);
         Uint8 red;
         Uint8 green;
         Uint8 blue;
@@ -995,6 +2379,104 @@ namespace TX {
         return result;
     }
 
+    inline bool txLockPixels(TXTYPE_PIXELBUFFER* buffer, HDC dc = txDC()) {
+        if (buffer == nullptr)
+            return false;
+        memset(buffer, 0, sizeof(TXTYPE_PIXELBUFFER));
+        SDL_Surface* surface = txLinUnportableLockSurface(dc);
+        if (surface == nullptr)
+            return false;
+        if (surface->format->BytesPerPixel != 4) {
+            txLinUnportableUnlockSurface(surface);
+            TXLIN_WARNING("txLockPixels only supports 32-bit surfaces, this one has " + txLinUnportableNumToCPlusPlusString(surface->format->BitsPerPixel) + " bits per pixel");
+            return false;
+        }
+        buffer->pixels = (Uint32*)(surface->pixels);
+        buffer->width = surface->w;
+        buffer->height = surface->h;
+        buffer->pitch = surface->pitch / 4;
+        buffer->surface = surface;
+        buffer->dc = dc;
+        txLinUnportableDamageAll(dc);
+        return true;
+    }
+
+    inline bool txUnlockPixels(TXTYPE_PIXELBUFFER* buffer) {
+        if (buffer == nullptr || buffer->surface == nullptr)
+            return false;
+        txLinUnportableUnlockSurface(buffer->surface);
+        memset(buffer, 0, sizeof(TXTYPE_PIXELBUFFER));
+        txLinUnportableCommitDrawing();
+        return true;
+    }
+
+    inline Uint32* txPixelRow(const TXTYPE_PIXELBUFFER* buffer, int y) {
+        if (buffer == nullptr || buffer->pixels == nullptr || y < 0 || y >= buffer->height)
+            return nullptr;
+        return buffer->pixels + (size_t)(y) * buffer->pitch;
+    }
+
+    inline Uint32 txPixelColor(const TXTYPE_PIXELBUFFER* buffer, COLORREF color) {
+        const SDL_PixelFormat* fmt = buffer->surface->format;
+        return ((Uint32)(color.r & 0xff) << fmt->Rshift) | ((Uint32)(color.g & 0xff) << fmt->Gshift) | ((Uint32)(color.b & 0xff) << fmt->Bshift) | fmt->Amask;
+    }
+
+    inline COLORREF txPixelToColor(const TXTYPE_PIXELBUFFER* buffer, Uint32 pixel) {
+        const SDL_PixelFormat* fmt = buffer->surface->format;
+        COLORREF result = { (int)((pixel >> fmt->Rshift) & 0xff), (int)((pixel >> fmt->Gshift) & 0xff), (int)((pixel >> fmt->Bshift) & 0xff) };
+        return result;
+    }
+
+    inline bool txPixelSetSpan(TXTYPE_PIXELBUFFER* buffer, int x0, int x1, int y, COLORREF color) {
+        Uint32* row = txPixelRow(buffer, y);
+        if (row == nullptr)
+            return false;
+        if (x0 > x1) {
+            int swapTmp = x0;
+            x0 = x1;
+            x1 = swapTmp;
+        }
+        x0 = MAX(x0, 0);
+        x1 = MIN(x1, buffer->width - 1);
+        Uint32 pixel = txPixelColor(buffer, color);
+        for (int x = x0; x <= x1; x++)
+            row[x] = pixel;
+        return true;
+    }
+
+    inline bool txPixelFillRect(TXTYPE_PIXELBUFFER* buffer, int x0, int y0, int x1, int y1, COLORREF color) {
+        if (buffer == nullptr || buffer->pixels == nullptr)
+            return false;
+        if (y0 > y1) {
+            int swapTmp = y0;
+            y0 = y1;
+            y1 = swapTmp;
+        }
+        y0 = MAX(y0, 0);
+        y1 = MIN(y1, buffer->height - 1);
+        for (int y = y0; y <= y1; y++)
+            txPixelSetSpan(buffer, x0, x1, y, color);
+        return true;
+    }
+
+    inline bool txPixelCopyRow(TXTYPE_PIXELBUFFER* buffer, int y, const Uint32* source, int x = 0, int count = -1) {
+        Uint32* row = txPixelRow(buffer, y);
+        if (row == nullptr || source == nullptr)
+            return false;
+        if (count < 0)
+            count = buffer->width - x;
+        if (x < 0) {
+            source = source - x;
+            count = count + x;
+            x = 0;
+        }
+        count = MIN(count, buffer->width - x);
+        if (count <= 0)
+            return false;
+        memcpy(row + x, source, (size_t)(count) * sizeof(Uint32));
+        return true;
+    }
+
     inline bool txUpdateWindow(bool doUpdate = true) {
         txLinUnportableAutomaticWindowUpdates = doUpdate;
         if (doUpdate)
@@ -1002,124 +2484,542 @@ namespace TX {
         return doUpdate;
     }
 
+    inline bool txLinUnportableEdgeTopLess(const TXTYPE_POLYEDGE& first, const TXTYPE_POLYEDGE& second) {
+        return first.yTop < second.yTop;
+    }
+
+    // active edge table scanline fill; pixels are sampled at their centers, contours are closed implicitly
+    inline void txLinUnportablePolygonSpans(const POINT* points, const int* contourSizes, int contours, int mode, int clipWidth, int clipHeight, std::vector<SDL_Rect>& spans) {
+        std::vector<TXTYPE_POLYEDGE> edges;
+        int base = 0;
+        for (int c = 0; c < contours; c++) {
+            int count = contourSizes[c];
+            for (int i = 0; i < count; i++) {
+                POINT from = points[base + i];
+                POINT to = points[base + ((i + 1) % count)];
+                if (from.y == to.y)
+                    continue;
+                TXTYPE_POLYEDGE edge;
+                edge.winding = (from.y < to.y) ? 1 : -1;
+                if (from.y > to.y) {
+                    POINT swapTmp = from;
+                    from = to;
+                    to = swapTmp;
+                }
+                edge.yTop = from.y;
+                edge.yBottom = to.y;
+                edge.xTop = from.x;
+                edge.slope = (to.x - from.x) / (to.y - from.y);
+                edges.push_back(edge);
+            }
+            base += count;
+        }
+        if (edges.empty())
+            return;
+        std::sort(edges.begin(), edges.end(), txLinUnportableEdgeTopLess);
+        double yMax = edges[0].yBottom;
+        for (size_t i = 1; i < edges.size(); i++)
+            yMax = MAX(yMax, edges[i].yBottom);
+        int firstRow = MAX(0, (int)(ceil(edges[0].yTop - 0.5)));
+        int lastRow = MIN(clipHeight - 1, (int)(ceil(yMax - 0.5)) - 1);
+
+        std::vector<int> active;
+        std::vector<std::pair<double, int> > crossings;
+        size_t nextEdge = 0;
+        for (int row = firstRow; row <= lastRow; row++) {
+            double sampleY = row + 0.5;
+            while (nextEdge < edges.size() && edges[nextEdge].yTop <= sampleY) {
+                active.push_back((int)(nextEdge));
+                nextEdge++;
+            }
+            crossings.clear();
+            for (size_t i = 0; i < active.size();) {
+                const TXTYPE_POLYEDGE& edge = edges[active[i]];
+                if (edge.yBottom <= sampleY) {
+                    active[i] = active.back();
+                    active.pop_back();
+                    continue;
+                }
+                if (edge.yTop <= sampleY)
+                    crossings.push_back(std::make_pair(edge.xTop + (sampleY - edge.yTop) * edge.slope, edge.winding));
+                i++;
+            }
+            std::sort(crossings.begin(), crossings.end());
+            int winding = 0;
+            for (size_t i = 0; i + 1 < crossings.size(); i++) {
+                if (mode == WINDING)
+                    winding += crossings[i].second;
+                else
+                    winding = (int)((i + 1) % 2);
+                if (winding == 0)
+                    continue;
+                int left = MAX(0, (int)(ceil(crossings[i].first - 0.5)));
+                int right = MIN(clipWidth - 1, (int)(ceil(crossings[i + 1].first - 0.5)) - 1);
+                txLinUnportableAddSpan(spans, left, right, row);
+            }
+        }
+    }
+
+    inline unsigned txSetLineStyle(unsigned style = PS_ENDCAP_ROUND | PS_JOIN_ROUND, HDC dc = txDC()) {
+        (void)(dc);
+        unsigned oldStyle = txLinUnportableLineStyle;
+        txLinUnportableLineStyle = style & (PS_ENDCAP_MASK | PS_JOIN_MASK);
+        return oldStyle;
+    }
+
+    inline unsigned txGetLineStyle(HDC dc = txDC()) {
+        (void)(dc);
+        return txLinUnportableLineStyle;
+    }
+
+    // the stroke is a union of convex pieces filled with the non-zero rule, so every piece gets the same orientation
+    inline void txLinUnportableStrokeAddPiece(std::vector<POINT>& points, std::vector<int>& sizes, const POINT* piece, int count) {
+        double area = 0.0;
+        for (int i = 0; i < count; i++)
+            area += piece[i].x * piece[(i + 1) % count].y - piece[(i + 1) % count].x * piece[i].y;
+        for (int i = 0; i < count; i++)
+            points.push_back((area >= 0.0) ? piece[i] : piece[count - 1 - i]);
+        sizes.push_back(count);
+    }
+
+    inline void txLinUnportableStrokeAddDisc(std::vector<POINT>& points, std::vector<int>& sizes, POINT center, double radius) {
+        int segments = MAX(8, MIN(96, (int)(radius * 4)));
+        std::vector<POINT> disc(segments);
+        for (int i = 0; i < segments; i++) {
+            double angle = (2.0 * txPI * i) / segments;
+            disc[i].x = center.x + radius * cos(angle);
+            disc[i].y = center.y + radius * sin(angle);
+        }
+        txLinUnportableStrokeAddPiece(points, sizes, &(disc[0]), segments);
+    }
+
+    // turns a polyline into filled pieces: one quad per segment plus joins and caps, rasterized as spans
+    inline void txLinUnportableStroke(const POINT* path, int count, bool closed, double thickness, COLORREF color, HDC dc) {
+        std::vector<POINT> vertices;
+        for (int i = 0; i < count; i++) {
+            POINT vertex = { path[i].x + 0.5, path[i].y + 0.5 };
+            if (vertices.empty() || vertex.x != vertices.back().x || vertex.y != vertices.back().y)
+                vertices.push_back(vertex);
+        }
+        if (closed && vertices.size() > 1 && vertices.front().x == vertices.back().x && vertices.front().y == vertices.back().y)
+            vertices.pop_back();
+        if (vertices.empty())
+            return;
+        double halfWidth = thickness / 2.0;
+        unsigned cap = txLinUnportableLineStyle & PS_ENDCAP_MASK;
+        unsigned join = txLinUnportableLineStyle & PS_JOIN_MASK;
+        std::vector<POINT> pieces;
+        std::vector<int> sizes;
+        int n = (int)(vertices.size());
+        if (n == 1) {
+            if (cap == PS_ENDCAP_ROUND)
+                txLinUnportableStrokeAddDisc(pieces, sizes, vertices[0], halfWidth);
+            else if (cap == PS_ENDCAP_SQUARE) {
+                POINT square[4] = { { vertices[0].x - halfWidth, vertices[0].y - halfWidth }, { vertices[0].x + halfWidth, vertices[0].y - halfWidth },
+                                    { vertices[0].x + halfWidth, vertices[0].y + halfWidth }, { vertices[0].x - halfWidth, vertices[0].y + halfWidth } };
+                txLinUnportableStrokeAddPiece(pieces, sizes, square, 4);
+            }
+        }
+        int segments = (closed && n > 2) ? n : n - 1;
+        std::vector<POINT> directions(segments);
+        for (int i = 0; i < segments; i++) {
+            POINT from = vertices[i];
+            POINT to = vertices[(i + 1) % n];
+            double length = sqrt(txSqr(to.x - from.x) + txSqr(to.y - from.y));
+            directions[i].x = (to.x - from.x) / length;
+            directions[i].y = (to.y - from.y) / length;
+            POINT normal = { -directions[i].y * halfWidth, directions[i].x * halfWidth };
+            POINT quad[4] = { { from.x + normal.x, from.y + normal.y }, { to.x + normal.x, to.y + normal.y },
+                              { to.x - normal.x, to.y - normal.y }, { from.x - normal.x, from.y - normal.y } };
+            txLinUnportableStrokeAddPiece(pieces, sizes, quad, 4);
+        }
+        // joins between consecutive segments
+        for (int i = 0; i < segments; i++) {
+            if (closed == false && i == segments - 1)
+                break;
+            POINT d1 = directions[i];
+            POINT d2 = directions[(i + 1) % segments];
+            POINT vertex = vertices[(i + 1) % n];
+            double cross = d1.x * d2.y - d1.y * d2.x;
+            double dot = d1.x * d2.x + d1.y * d2.y;
+            if (fabs(cross) < 1e-9 && dot > 0.0)
+                continue;
+            if (join == PS_JOIN_ROUND) {
+                txLinUnportableStrokeAddDisc(pieces, sizes, vertex, halfWidth);
+                continue;
+            }
+            double side = (cross > 0.0) ? -1.0 : 1.0;
+            POINT outer1 = { vertex.x - side * d1.y * halfWidth, vertex.y + side * d1.x * halfWidth };
+            POINT outer2 = { vertex.x - side * d2.y * halfWidth, vertex.y + side * d2.x * halfWidth };
+            POINT miterDirection = { (outer1.x + outer2.x) / 2.0 - vertex.x, (outer1.y + outer2.y) / 2.0 - vertex.y };
+            double miterLength = sqrt(txSqr(miterDirection.x) + txSqr(miterDirection.y));
+            // same miter limit as GDI: ten times the half width
+            if (join == PS_JOIN_MITER && miterLength > 1e-9 && (halfWidth * halfWidth / miterLength) <= 10.0 * halfWidth) {
+                double scale = (halfWidth * halfWidth / miterLength) / miterLength;
+                POINT tip = { vertex.x + miterDirection.x * scale, vertex.y + miterDirection.y * scale };
+                POINT miter[4] = { vertex, outer1, tip, outer2 };
+                txLinUnportableStrokeAddPiece(pieces, sizes, miter, 4);
+            }
+            else {
+                POINT bevel[3] = { vertex, outer1, outer2 };
+                txLinUnportableStrokeAddPiece(pieces, sizes, bevel, 3);
+            }
+        }
+        // caps at both ends of an open path
+        if (closed == false && segments > 0 && cap != PS_ENDCAP_FLAT) {
+            for (int end = 0; end < 2; end++) {
+                POINT vertex = (end == 0) ? vertices[0] : vertices[n - 1];
+                POINT outwards = (end == 0) ? directions[0] : directions[segments - 1];
+                if (end == 0) {
+                    outwards.x = -outwards.x;
+                    outwards.y = -outwards.y;
+                }
+                if (cap == PS_ENDCAP_ROUND)
+                    txLinUnportableStrokeAddDisc(pieces, sizes, vertex, halfWidth);
+                else {
+                    POINT normal = { -outwards.y * halfWidth, outwards.x * halfWidth };
+                    POINT tip = { vertex.x + outwards.x * halfWidth, vertex.y + outwards.y * halfWidth };
+                    POINT square[4] = { { vertex.x + normal.x, vertex.y + normal.y }, { tip.x + normal.x, tip.y + normal.y },
+                                        { tip.x - normal.x, tip.y - normal.y }, { vertex.x - normal.x, vertex.y - normal.y } };
+                    txLinUnportableStrokeAddPiece(pieces, sizes, square, 4);
+                }
+            }
+        }
+        if (sizes.empty())
+            return;
+        std::vector<SDL_Rect> spans;
+        POINT extent = txGetExtent(dc);
+        txLinUnportablePolygonSpans(&(pieces[0]), &(sizes[0]), (int)(sizes.size()), WINDING, (int)(extent.x), (int)(extent.y), spans);
+        txLinUnportableSubmitRects(dc, spans, color);
+    }
+
     inline bool txLine (double x0, double y0, double x1, double y1, HDC dc = txDC(), bool mtVer = false) {
         if (dc == nullptr) {
             DBGOUT << "dc is nullptr, return false" << std::endl;
             return false;
         }
-        SDL_RenderDrawLine(dc, (int)(x0), (int)(y0), (int)(x1), (int)(y1));
+        TXLIN_UNPORTABLEDEF_STATSCOPE(TX_STAT_LINE);
+        // kept for source compatibility, lines drawn by worker threads are queued for the main thread anyway
+        (void)(mtVer);
         if (txLinUnportableLineThickness > 1) {
-            for (int i = 1; i < txLinUnportableLineThickness; i++)
-                SDL_RenderDrawLine(dc, (int)(x0) + i, (int)(y0), (int)(x1) + i, (int)(y1));
+            POINT path[2] = { { x0, y0 }, { x1, y1 } };
+            txLinUnportableStroke(path, 2, false, txLinUnportableLineThickness, txLinUnportableLastDrawColor, dc);
         }
-        if (txLinUnportableAutomaticWindowUpdates && mtVer == false)
-            txRedrawWindow();
+        else
+            txLinUnportableSubmitCommand(dc, TXLIN_UNPORTABLEDEF_COMMAND_LINE, txLinUnportableLastDrawColor, (int)(x0), (int)(y0), (int)(x1), (int)(y1));
+        txLinUnportableCommitDrawing();
         return true;
     }
 
-    inline bool txRectangle (double x0, double y0, double x1, double y1, HDC dc = txDC()) {
-        if (dc == nullptr)
+    inline bool txPolyline (const POINT* points, int numPoints, HDC dc = txDC()) {
+        if (dc == nullptr || points == nullptr || numPoints <= 0)
             return false;
+        TXLIN_UNPORTABLEDEF_STATSCOPE(TX_STAT_POLYGON);
+        if (txLinUnportableLineThickness > 1)
+            txLinUnportableStroke(points, numPoints, false, txLinUnportableLineThickness, txLinUnportableLastDrawColor, dc);
+        else {
+            for (int i = 1; i < numPoints; i++)
+                txLinUnportableSubmitCommand(dc, TXLIN_UNPORTABLEDEF_COMMAND_LINE, txLinUnportableLastDrawColor, (int)(points[i - 1].x), (int)(points[i - 1].y), (int)(points[i].x), (int)(points[i].y));
+        }
+        txLinUnportableCommitDrawing();
+        return true;
+    }
+
+    inline SDL_Rect txLinUnportableRectToSDL(double x0, double y0, double x1, double y1) {
         SDL_Rect rectangle;
-        rectangle.x = (int)(x0);
-        rectangle.y = (int)(y0);
-        rectangle.w = txLinUnportableModule(x1 - x0);
-        rectangle.h = txLinUnportableModule(y1 - y0);
-        SDL_RenderDrawRect(dc, &rectangle);
-        if (txGetFillColor() != TX_TRANSPARENT) {
-#ifdef TXLIN_NO_USE_FLOODFILL_IN_RECTANGLES
-            double xFinal = rectangle.x + rectangle.w;
-            COLORREF oldColor = txGetColor();
-            txSetColor(txGetFillColor());
-            for (unsigned i = (unsigned)(rectangle.y); i < ((unsigned)(rectangle.y) + (unsigned)(rectangle.h)); i++)
-                txLine(xFinal, i, rectangle.x, i, dc);
-            txSetColor(oldColor);
-#else
-            txFloodFill(x0, y0, txGetPixel(x0 + 1, y0 + 1, dc), FLOODFILLSURFACE, dc);
-#endif
+        rectangle.x = (int)(MIN(x0, x1));
+        rectangle.y = (int)(MIN(y0, y1));
+        rectangle.w = txLinUnportableModule((int)(x1 - x0));
+        rectangle.h = txLinUnportableModule((int)(y1 - y0));
+        return rectangle;
+    }
+
+    // fills go first so that the outlines stay on top; TX_TRANSPARENT as a color skips that part
+    inline bool txRectangles (const RECT* rects, int count, HDC dc = txDC(), const COLORREF* fillColors = nullptr) {
+        if (dc == nullptr || rects == nullptr || count <= 0)
+            return false;
+        TXLIN_UNPORTABLEDEF_STATSCOPE(TX_STAT_RECTANGLE);
+        std::vector<SDL_Rect> batch;
+        batch.reserve(count);
+        if (fillColors != nullptr) {
+            int runStart = 0;
+            for (int i = 0; i <= count; i++) {
+                if (i < count && fillColors[i] == fillColors[runStart]) {
+                    batch.push_back(txLinUnportableRectToSDL(rects[i].left, rects[i].top, rects[i].right, rects[i].bottom));
+                    continue;
+                }
+                if (fillColors[runStart] != TX_TRANSPARENT)
+                    txLinUnportableSubmitRects(dc, batch, fillColors[runStart]);
+                batch.clear();
+                runStart = i;
+                if (i < count)
+                    batch.push_back(txLinUnportableRectToSDL(rects[i].left, rects[i].top, rects[i].right, rects[i].bottom));
+            }
         }
-        if (txLinUnportableAutomaticWindowUpdates)
-            txRedrawWindow();
+        else if (txGetFillColor() != TX_TRANSPARENT) {
+            for (int i = 0; i < count; i++)
+                batch.push_back(txLinUnportableRectToSDL(rects[i].left, rects[i].top, rects[i].right, rects[i].bottom));
+            txLinUnportableSubmitRects(dc, batch, txGetFillColor());
+        }
+        if (txGetColor() != TX_TRANSPARENT) {
+            batch.clear();
+            for (int i = 0; i < count; i++)
+                batch.push_back(txLinUnportableRectToSDL(rects[i].left, rects[i].top, rects[i].right, rects[i].bottom));
+            txLinUnportableSubmitRects(dc, batch, txGetColor(), false);
+        }
+        txLinUnportableCommitDrawing();
         return true;
     }
 
-    inline bool txPolygon (const POINT* points, int numPoints, HDC dc = txDC()) {
+    inline bool txRectangle (double x0, double y0, double x1, double y1, HDC dc = txDC()) {
         if (dc == nullptr)
             return false;
-        SDL_Point* sdlPoints = txLinUnportablePointCapsToSDL(points, numPoints);
-        SDL_RenderDrawLines(dc, sdlPoints, numPoints);
+        TXLIN_UNPORTABLEDEF_STATSCOPE(TX_STAT_RECTANGLE);
+        SDL_Rect rectangle = txLinUnportableRectToSDL(x0, y0, x1, y1);
         if (txGetFillColor() != TX_TRANSPARENT)
-            txFloodFill((double)(sdlPoints[0].x), (double)(sdlPoints[0].y), txGetFillColor(), FLOODFILLSURFACE, dc);
+            txLinUnportableSubmitCommand(dc, TXLIN_UNPORTABLEDEF_COMMAND_FILLRECT, txGetFillColor(), rectangle.x, rectangle.y, rectangle.x + rectangle.w, rectangle.y + rectangle.h);
+        if (txGetColor() != TX_TRANSPARENT)
+            txLinUnportableSubmitCommand(dc, TXLIN_UNPORTABLEDEF_COMMAND_RECT, txLinUnportableLastDrawColor, rectangle.x, rectangle.y, rectangle.x + rectangle.w, rectangle.y + rectangle.h);
+        txLinUnportableCommitDrawing();
+        return true;
+    }
+
+    inline int txSetPolyFillMode(int mode = ALTERNATE, HDC dc = txDC()) {
+        (void)(dc);
+        int oldMode = txLinUnportablePolyFillMode;
+        if (mode == ALTERNATE || mode == WINDING)
+            txLinUnportablePolyFillMode = mode;
+        return oldMode;
+    }
+
+    inline int txGetPolyFillMode(HDC dc = txDC()) {
+        (void)(dc);
+        return txLinUnportablePolyFillMode;
+    }
+
+    inline bool txPolygon (const POINT* points, int numPoints, HDC dc = txDC()) {
+        if (dc == nullptr || points == nullptr || numPoints <= 0)
+            return false;
+        TXLIN_UNPORTABLEDEF_STATSCOPE(TX_STAT_POLYGON);
+        if (txGetFillColor() != TX_TRANSPARENT) {
+            std::vector<SDL_Rect> spans;
+            POINT extent = txGetExtent(dc);
+            txLinUnportablePolygonSpans(points, &numPoints, 1, txLinUnportablePolyFillMode, (int)(extent.x), (int)(extent.y), spans);
+            txLinUnportableSubmitRects(dc, spans, txGetFillColor());
+        }
+        if (txLinUnportableLineThickness > 1) {
+            txLinUnportableStroke(points, numPoints, true, txLinUnportableLineThickness, txLinUnportableLastDrawColor, dc);
+            txLinUnportableCommitDrawing();
+            return true;
+        }
+        SDL_Point* sdlPoints = txLinUnportablePointCapsToSDL(points, numPoints);
+        for (int i = 0; i < numPoints; i++) {
+            int next = (i + 1) % numPoints;
+            txLinUnportableSubmitCommand(dc, TXLIN_UNPORTABLEDEF_COMMAND_LINE, txLinUnportableLastDrawColor, sdlPoints[i].x, sdlPoints[i].y, sdlPoints[next].x, sdlPoints[next].y);
+        }
         free(sdlPoints);
         sdlPoints = nullptr;
-        if (txLinUnportableAutomaticWindowUpdates)
-            txRedrawWindow();
+        txLinUnportableCommitDrawing();
         return true;
     }
 
     inline bool txCircle (double x, double y, double r, HDC dc = txDC()) {
-        return txEllipse(x - (r / 2), y - (r / 2), x + (r / 2), y + (r / 2), dc);
+        return txEllipse(x - r, y - r, x + r, y + r, dc);
     }
 
     bool txFloodFill (double x, double y, COLORREF realOld, DWORD mode, HDC dc) {
         if (dc == nullptr)
             return false;
-        if (x >= txGetExtentX() || y >= txGetExtentY())
+        TXLIN_UNPORTABLEDEF_STATSCOPE(TX_STAT_FLOODFILL);
+        SDL_Surface* surface = txLinUnportableLockSurface(dc);
+        if (surface == nullptr)
             return false;
-#ifdef TXLIN_FAST_UNSTABLE_FLOODFILL
-#warning "This flood fill algorithm might be faster, but it crashes a lot. Use at your own risk."
-        TXLIN_WARNING("txFloodFill() was built with TXLIN_FAST_UNSTABLE_FLOODFILL macros enabled. This means that this function might crash at some point because of stack overflow.");
-        if (txGetPixel(x, y, dc) == realOld) {
-            txSetPixel(x, y, color, dc);
-            txFloodFill(x + 1, y, color, mode, dc, realOld);
-            txFloodFill(x, y + 1, color, mode, dc, realOld);
-            txFloodFill(x - 1, y, color, mode, dc, realOld);
-            txFloodFill(x, y - 1, color, mode, dc, realOld);
+        int width = surface->w;
+        int height = surface->h;
+        int seedX = (int)(x);
+        int seedY = (int)(y);
+        if (seedX < 0 || seedY < 0 || seedX >= width || seedY >= height) {
+            txLinUnportableUnlockSurface(surface);
+            return false;
+        }
+        txLinUnportableDamageAll(dc);
+        // alpha bits of window surfaces are undefined, compare colors only
+        Uint32 colorMask = surface->format->Rmask | surface->format->Gmask | surface->format->Bmask;
+        if (colorMask == 0)
+            colorMask = 0xffffffff;
+        Uint32 fill = txLinUnportableMapColor(surface, txGetFillColor()) & colorMask;
+        Uint32 reference = txLinUnportableGetPixel(surface, seedX, seedY) & colorMask;
+        if (realOld != TX_TRANSPARENT)
+            reference = txLinUnportableMapColor(surface, realOld) & colorMask;
+        bool borderMode = (mode == FLOODFILLBORDER);
+        if (borderMode == false && reference == fill) {
+            txLinUnportableUnlockSurface(surface);
+            return true;
+        }
+
+        // FLOODFILLSURFACE repaints the area of the reference color,
+        // FLOODFILLBORDER repaints everything up to the reference (border) color
+        #define _txFloodFill_INTERNALINSIDE(px, py) (borderMode ? \
+                    ((txLinUnportableGetPixel(surface, (px), (py)) & colorMask) != reference && (txLinUnportableGetPixel(surface, (px), (py)) & colorMask) != fill) : \
+                    ((txLinUnportableGetPixel(surface, (px), (py)) & colorMask) == reference))
+
+        std::vector<SDL_Point> seeds;
+        SDL_Point seed = { seedX, seedY };
+        seeds.push_back(seed);
+        while (seeds.empty() == false) {
+            SDL_Point current = seeds.back();
+            seeds.pop_back();
+            if (_txFloodFill_INTERNALINSIDE(current.x, current.y) == false)
+                continue;
+            int left = current.x;
+            int right = current.x;
+            while (left > 0 && _txFloodFill_INTERNALINSIDE(left - 1, current.y))
+                left--;
+            while (right < width - 1 && _txFloodFill_INTERNALINSIDE(right + 1, current.y))
+                right++;
+            for (int xpos = left; xpos <= right; xpos++)
+                txLinUnportablePutPixel(surface, xpos, current.y, fill);
+            TXLIN_UNPORTABLEDEF_STATPIXELS(right - left + 1);
+            // one seed per run of fillable pixels on the neighbouring rows
+            for (int ypos = current.y - 1; ypos <= current.y + 1; ypos += 2) {
+                if (ypos < 0 || ypos >= height)
+                    continue;
+                bool inRun = false;
+                for (int xpos = left; xpos <= right; xpos++) {
+                    bool inside = _txFloodFill_INTERNALINSIDE(xpos, ypos);
+                    if (inside && inRun == false) {
+                        SDL_Point next = { xpos, ypos };
+                        seeds.push_back(next);
+                    }
+                    inRun = inside;
+                }
+            }
+        }
+        #undef _txFloodFill_INTERNALINSIDE
+
+        txLinUnportableUnlockSurface(surface);
+        txLinUnportableCommitDrawing();
+        return true;
+    }
+
+    inline void txLinUnportableSDLEventLoop() {
+        // nobody can close a window that does not exist
+        if (txLinUnportableHeadless)
+            return;
+        bool stop = false;
+        while (stop == false) {
+            if (txLinUnportableSDLProcessEvents() == TXLIN_UNPORTABLEDEF_EVENTPROCESSING_QUIT) {
+                stop = true;
+                break;
+            }
+        }
+        return;
+    }
+
+    // txBegin/txEnd bracket a frame: primitives drawn in between are queued and presented once
+    inline int txBegin() {
+        txLinUnportableFrameDepth++;
+        return txLinUnportableFrameDepth;
+    }
+
+    inline int txEnd() {
+        if (txLinUnportableFrameDepth > 0)
+            txLinUnportableFrameDepth--;
+        if (txLinUnportableFrameDepth == 0) {
+            txRedrawWindow();
+            txLinUnportableStatsEndFrame();
         }
+        return txLinUnportableFrameDepth;
+    }
+
+    // SDL_Delay may oversleep by a millisecond or two, so the last bit is waited out by polling the counter
+    inline void txLinUnportableWaitUntil(Uint64 deadline) {
+        Uint64 frequency = SDL_GetPerformanceFrequency();
+        Uint64 now = SDL_GetPerformanceCounter();
+        while (now < deadline) {
+            Uint64 remainingMs = (deadline - now) * 1000 / frequency;
+            if (remainingMs > 2)
+                SDL_Delay((Uint32)(remainingMs - 2));
+            else
+                SDL_Delay(0);
+            now = SDL_GetPerformanceCounter();
+        }
+    }
+
+    inline double txSetFPS(double fps = 60) {
+        double oldFPS = txLinUnportableTargetFPS;
+        txLinUnportableTargetFPS = (fps > 0) ? fps : 0;
+        txLinUnportableFrameDeadline = 0;
+        return oldFPS;
+    }
+
+    inline double txGetFPS() {
+        return txLinUnportableTargetFPS;
+    }
+
+    inline bool txSetVSync(bool value = true) {
+        txLinUnportableVSync = false;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        if (txLinUnportableHeadless == false && txDC() != nullptr && SDL_RenderSetVSync(txDC(), (value) ? 1 : 0) == 0)
+            txLinUnportableVSync = value;
 #else
-        txUpdateWindow(false);
-        std::vector<POINT> pointsMatching;
-        pointsMatching.clear();
-        for (int ypos = (int)(y); ypos < txGetExtentY(); ypos++) {
-            for (int xpos = (int)(x); xpos < txGetExtentX(); xpos++) {
-                bool criteriaMatch = (txGetPixel(xpos, ypos, dc) == realOld);
-                if (mode == FLOODFILLBORDER)
-                    criteriaMatch = !(criteriaMatch);
-                if (criteriaMatch)
-                    txSetPixel(xpos, ypos, txGetFillColor(), dc);
-            }
-        }
-        txUpdateWindow(true);
+        (void)(value);
 #endif
-        return true;
+        return txLinUnportableVSync;
+    }
 
+    inline unsigned txGetMissedFrames() {
+        return txLinUnportableMissedFrames;
     }
 
-    inline void txLinUnportableSDLEventLoop() {
-        bool stop = false;
-        while (stop == false) {
-            if (txLinUnportableSDLProcessOneEvent() == TXLIN_UNPORTABLEDEF_EVENTPROCESSING_QUIT) {
-                stop = true;
-                break;
-            }
-        }
-        return;
+    inline TXTYPE_STATCOUNTER txGetStat(int counter) {
+        TXTYPE_STATCOUNTER result = { nullptr, 0, 0, 0.0 };
+        if (counter < 0 || counter >= TX_STAT_COUNT)
+            return result;
+#ifdef TXLIN_STATS
+        result = txLinUnportableLastStats[counter];
+#endif
+        result.name = txLinUnportableStatNames[counter];
+        return result;
     }
 
-    inline int txBegin() {
-        bool result = txUpdateWindow(false);
-        if (result)
-            return 0;
-        return 1;
+    inline bool txSetStatsOverlay(bool value = true) {
+#ifdef TXLIN_STATS
+        txLinUnportableStatsOverlay = value;
+        return true;
+#else
+        (void)(value);
+        TXLIN_WARNING("txSetStatsOverlay needs TXLin to be compiled with TXLIN_STATS defined");
+        return false;
+#endif
     }
 
-    inline int txEnd() {
-        bool result = txUpdateWindow(true);
-        if (result) {
-            txLinUnportableSDLProcessOneEvent();
-            return 0;
+    // txBeginFrame/txEndFrame is txBegin/txEnd that also keeps the loop at the FPS set with txSetFPS
+    inline int txBeginFrame() {
+        txLinUnportableFrameStart = SDL_GetPerformanceCounter();
+        return txBegin();
+    }
+
+    // returns how long the frame took without the waiting, in milliseconds
+    inline double txEndFrame() {
+        txEnd();
+        Uint64 now = SDL_GetPerformanceCounter();
+        double frameTime = (double)(now - txLinUnportableFrameStart) * 1000.0 / SDL_GetPerformanceFrequency();
+        if (txLinUnportableTargetFPS <= 0)
+            return frameTime;
+        // deadlines follow each other exactly one period apart, so waiting errors do not add up
+        Uint64 period = (Uint64)(SDL_GetPerformanceFrequency() / txLinUnportableTargetFPS);
+        if (txLinUnportableFrameDeadline == 0)
+            txLinUnportableFrameDeadline = txLinUnportableFrameStart;
+        txLinUnportableFrameDeadline += period;
+        if (now > txLinUnportableFrameDeadline) {
+            // a late frame starts a new schedule instead of rushing the next ones to catch up
+            txLinUnportableMissedFrames++;
+            txLinUnportableFrameDeadline = now;
         }
-        return 1;
+        else if (txLinUnportableHeadless == false)
+            txLinUnportableWaitUntil(txLinUnportableFrameDeadline);
+        return frameTime;
     }
 
     #define _txLine(v1, v2, v3, v4) txLine(v1, v2, v3, v4, dc)
@@ -1339,6 +3239,155 @@ namespace TX {
 
     #undef _txLine
 
+    inline TXTYPE_FONTCACHE* txLinUnportableGetFont(const char* path, int size) {
+        if (path == nullptr)
+            return nullptr;
+        std::pair<std::string, int> key(path, size);
+        std::map<std::pair<std::string, int>, TXTYPE_FONTCACHE>::iterator found = txLinUnportableFontCache.find(key);
+        if (found != txLinUnportableFontCache.end())
+            return &(found->second);
+        if (TTF_WasInit() != 1)
+            TTF_Init();
+        TXLIN_UNPORTABLEDEF_STATSCOPE(TX_STAT_FONTOPEN);
+        TTF_Font* ttfObj = TTF_OpenFont(path, size);
+        if (ttfObj == nullptr) {
+            TXLIN_WARNING("TTF_GetError() reports: " + std::string(TTF_GetError()) + ", text cannot be displayed");
+            return nullptr;
+        }
+        TXTYPE_FONTCACHE& entry = txLinUnportableFontCache[key];
+        entry.font = ttfObj;
+        for (int i = 0; i < 128; i++)
+            entry.asciiAdvances[i] = -1;
+        for (int i = 0; i < 2; i++) {
+            entry.atlases[i].surface = nullptr;
+            entry.atlases[i].shelfX = 0;
+            entry.atlases[i].shelfY = 0;
+            entry.atlases[i].shelfHeight = 0;
+        }
+        return &entry;
+    }
+
+    void txLinUnportableReleaseFonts() {
+        for (std::map<std::pair<std::string, int>, TXTYPE_FONTCACHE>::iterator it = txLinUnportableFontCache.begin(); it != txLinUnportableFontCache.end(); it++) {
+            for (int i = 0; i < 2; i++) {
+                if (it->second.atlases[i].surface != nullptr)
+                    SDL_FreeSurface(it->second.atlases[i].surface);
+            }
+            TTF_CloseFont(it->second.font);
+        }
+        txLinUnportableFontCache.clear();
+    }
+
+    // reads one UTF-8 sequence and moves the cursor past it, broken bytes are returned as they are
+    inline Uint32 txLinUnportableDecodeUTF8(const char*& cursor) {
+        const unsigned char* bytes = (const unsigned char*)(cursor);
+        int length = 1;
+        Uint32 codepoint = bytes[0];
+        if (bytes[0] >= 0xF0)
+            length = 4;
+        else if (bytes[0] >= 0xE0)
+            length = 3;
+        else if (bytes[0] >= 0xC0)
+            length = 2;
+        if (length > 1) {
+            codepoint = bytes[0] & (0xFF >> (length + 1));
+            for (int i = 1; i < length; i++) {
+                if ((bytes[i] & 0xC0) != 0x80) {
+                    cursor++;
+                    return bytes[0];
+                }
+                codepoint = (codepoint << 6) | (bytes[i] & 0x3F);
+            }
+        }
+        cursor += length;
+        return codepoint;
+    }
+
+    inline int txLinUnportableGlyphAdvance(TXTYPE_FONTCACHE* cachedFont, const char* sequence, int length, Uint32 codepoint) {
+        if (codepoint < 128 && cachedFont->asciiAdvances[codepoint] >= 0)
+            return cachedFont->asciiAdvances[codepoint];
+        std::map<Uint32, int>::iterator found = cachedFont->advances.find(codepoint);
+        if (found != cachedFont->advances.end())
+            return found->second;
+        int advance = 0;
+        if (codepoint > 0xFFFF || TTF_GlyphMetrics(cachedFont->font, (Uint16)(codepoint), nullptr, nullptr, nullptr, nullptr, &advance) != 0) {
+            // TTF_GlyphMetrics only takes UCS-2, so measure the character as a string instead
+            std::string character(sequence, length);
+            if (TTF_SizeUTF8(cachedFont->font, character.c_str(), &advance, nullptr) != 0)
+                advance = 0;
+        }
+        if (codepoint < 128)
+            cachedFont->asciiAdvances[codepoint] = advance;
+        else
+            cachedFont->advances[codepoint] = advance;
+        return advance;
+    }
+
+    inline const TXTYPE_GLYPH* txLinUnportableGetGlyph(TXTYPE_FONTCACHE* cachedFont, int mode, const char* sequence, int length, Uint32 codepoint) {
+        TXTYPE_GLYPHATLAS& atlas = cachedFont->atlases[mode];
+        std::map<Uint32, TXTYPE_GLYPH>::iterator found = atlas.glyphs.find(codepoint);
+        if (found != atlas.glyphs.end())
+            return &(found->second);
+        std::string character(sequence, length);
+        SDL_Color white = { 255, 255, 255, 255 };
+        SDL_Surface* rendered = (mode == TXLIN_UNPORTABLEDEF_GLYPHMODE_BLENDED) ? TTF_RenderUTF8_Blended(cachedFont->font, character.c_str(), white) : TTF_RenderUTF8_Solid(cachedFont->font, character.c_str(), white);
+        if (rendered == nullptr) {
+            TXLIN_WARNING("TTF_GetError() reports: " + std::string(TTF_GetError()) + ", text cannot be displayed");
+            return nullptr;
+        }
+        SDL_Surface* glyphSurface = SDL_ConvertSurfaceFormat(rendered, SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_FreeSurface(rendered);
+        if (glyphSurface == nullptr)
+            return nullptr;
+        SDL_SetSurfaceBlendMode(glyphSurface, SDL_BLENDMODE_NONE);
+
+        // shelf packing, the atlas only grows downwards
+        int atlasWidth = (atlas.surface != nullptr) ? atlas.surface->w : MAX(TXLIN_UNPORTABLEDEF_GLYPHATLAS_WIDTH, glyphSurface->w);
+        if (atlas.shelfX + glyphSurface->w > atlasWidth) {
+            atlas.shelfY += atlas.shelfHeight;
+            atlas.shelfX = 0;
+            atlas.shelfHeight = 0;
+        }
+        int neededHeight = atlas.shelfY + glyphSurface->h;
+        if (atlas.surface == nullptr || neededHeight > atlas.surface->h || glyphSurface->w > atlasWidth) {
+            int newWidth = MAX(atlasWidth, glyphSurface->w);
+            int newHeight = (atlas.surface != nullptr) ? atlas.surface->h : glyphSurface->h * 4;
+            while (newHeight < neededHeight)
+                newHeight *= 2;
+            SDL_Surface* grown = SDL_CreateRGBSurfaceWithFormat(0, newWidth, newHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+            if (grown == nullptr) {
+                SDL_FreeSurface(glyphSurface);
+                return nullptr;
+            }
+            SDL_FillRect(grown, nullptr, 0);
+            if (atlas.surface != nullptr) {
+                SDL_SetSurfaceBlendMode(atlas.surface, SDL_BLENDMODE_NONE);
+                SDL_BlitSurface(atlas.surface, nullptr, grown, nullptr);
+                SDL_FreeSurface(atlas.surface);
+            }
+            SDL_SetSurfaceBlendMode(grown, SDL_BLENDMODE_BLEND);
+            atlas.surface = grown;
+        }
+        TXTYPE_GLYPH glyph;
+        glyph.rect.x = atlas.shelfX;
+        glyph.rect.y = atlas.shelfY;
+        glyph.rect.w = glyphSurface->w;
+        glyph.rect.h = glyphSurface->h;
+        SDL_Rect dstRect = glyph.rect;
+        SDL_BlitSurface(glyphSurface, nullptr, atlas.surface, &dstRect);
+        SDL_FreeSurface(glyphSurface);
+        atlas.shelfX += glyph.rect.w;
+        atlas.shelfHeight = MAX(atlas.shelfHeight, glyph.rect.h);
+
+        int minX = 0;
+        if (codepoint > 0xFFFF || TTF_GlyphMetrics(cachedFont->font, (Uint16)(codepoint), &minX, nullptr, nullptr, nullptr, nullptr) != 0)
+            minX = 0;
+        // a single rendered character starts at its left bearing when that one is negative
+        glyph.offsetX = MIN(minX, 0);
+        glyph.advance = txLinUnportableGlyphAdvance(cachedFont, sequence, length, codepoint);
+        return &(atlas.glyphs[codepoint] = glyph);
+    }
+
     inline bool txTextOut(double x, double y, const char* text, HDC dc = txDC(), bool ignoreTextAlignSettings = false) {
         if (dc == nullptr)
             return false;
@@ -1348,10 +3397,12 @@ namespace TX {
             else if (txLinUnportableTextAlign == TA_TOP)
                 return txTextOut(x, y - (txGetTextExtent(text, dc).cy), text, dc, true);
         }
+        TXLIN_UNPORTABLEDEF_STATSCOPE(TX_STAT_TEXT);
         int oldThickness = txLinUnportableLineThickness;
         txSetColor(txGetColor(), 1, dc);
         int posx = (int)(x);
         int posy = (int)(y);
+        txLinUnportableFrameDepth++;
         if (txLinUnportableUseMonolithic) {
             for (int i = 0; i < strlen(text); i++) {
                 if (text[i] != '\n') {
@@ -1365,32 +3416,53 @@ namespace TX {
             }
         }
         else {
-            const char* ttfPath = txLinUnportableFindFont();
-            if (TTF_WasInit() != 1)
-                TTF_Init();
-            TTF_Font* ttfObj = TTF_OpenFont(ttfPath, TXLIN_TEXTSET_MAXHEIGHT);
-            Uint8 r = txGetColor().r;
-            Uint8 g = txGetColor().g;
-            Uint8 b = txGetColor().b;
-            SDL_Color currentColor = { r, g, b, 0 };
-            SDL_Surface* ttfSurface = TTF_RenderUTF8_Solid(ttfObj, text, currentColor);
-            if (ttfSurface == nullptr) {
-                TTF_CloseFont(ttfObj);
-                TXLIN_WARNING("TTF_GetError() reports: " + std::string(TTF_GetError()) + ", text cannot be displayed");
+            TXTYPE_FONTCACHE* cachedFont = txLinUnportableGetFont(txLinUnportableFindFont(), TXLIN_TEXTSET_MAXHEIGHT);
+            if (cachedFont == nullptr) {
+                txSetColor(txGetColor(), oldThickness, dc);
+                txLinUnportableFrameDepth--;
                 return false;
             }
-            TTF_CloseFont(ttfObj);
-            SDL_Rect dstRect;
-            dstRect.x = x;
-            dstRect.y = y;
-            dstRect.w = ttfSurface->w;
-            dstRect.h = ttfSurface->h;
-            if (SDL_BlitSurface(ttfSurface, nullptr, SDL_GetWindowSurface(SDL_GetWindowFromID(txWindow())), &dstRect) != 0)
-                TXLIN_WARNING("SDL_GetError() reports: " + std::string(SDL_GetError()) + ", blit failed, text cannot be displayed");
-            SDL_free(ttfSurface);
+#ifdef TXLIN_ANTIALIASED_TEXT
+            int glyphMode = TXLIN_UNPORTABLEDEF_GLYPHMODE_BLENDED;
+#else
+            int glyphMode = TXLIN_UNPORTABLEDEF_GLYPHMODE_SOLID;
+#endif
+            // the glyphs are blitted straight into the surface, so queued primitives have to land first
+            txLinUnportableSyncSurface(dc);
+            SDL_Surface* target = txLinUnportableSurfaceOf(dc);
+            COLORREF currentColor = txGetColor();
+            SDL_Surface* tintedAtlas = nullptr;
+            const char* cursor = text;
+            while (*cursor != '\0') {
+                const char* sequence = cursor;
+                Uint32 codepoint = txLinUnportableDecodeUTF8(cursor);
+                if (codepoint == '\n') {
+                    posx = (int)(x);
+                    posy = posy + TTF_FontLineSkip(cachedFont->font);
+                    continue;
+                }
+                const TXTYPE_GLYPH* glyph = txLinUnportableGetGlyph(cachedFont, glyphMode, sequence, (int)(cursor - sequence), codepoint);
+                if (glyph == nullptr)
+                    continue;
+                SDL_Surface* atlasSurface = cachedFont->atlases[glyphMode].surface;
+                if (atlasSurface != tintedAtlas) {
+                    SDL_SetSurfaceColorMod(atlasSurface, currentColor.r, currentColor.g, currentColor.b);
+                    tintedAtlas = atlasSurface;
+                }
+                SDL_Rect srcRect = glyph->rect;
+                SDL_Rect dstRect = { posx + glyph->offsetX, posy, glyph->rect.w, glyph->rect.h };
+                if (SDL_BlitSurface(atlasSurface, &srcRect, target, &dstRect) != 0) {
+                    TXLIN_WARNING("SDL_GetError() reports: " + std::string(SDL_GetError()) + ", blit failed, text cannot be displayed");
+                    break;
+                }
+                txLinUnportableAddDamage(dc, posx + glyph->offsetX, posy, glyph->rect.w, glyph->rect.h);
+                TXLIN_UNPORTABLEDEF_STATPIXELS((Uint64)(glyph->rect.w) * glyph->rect.h);
+                posx = posx + glyph->advance;
+            }
         }
         txSetColor(txGetColor(), oldThickness, dc);
-        txRedrawWindow();
+        txLinUnportableFrameDepth--;
+        txLinUnportableCommitDrawing();
         return true;
     }
 
@@ -1443,63 +3515,85 @@ namespace TX {
     #define NULLIFY(func) (void)(#func)
 
 
-    inline bool txLinUnportableEllipseClassicImplementation(double x0, double y0, int width, int height, HDC dc = txDC()) {
+    // midpoint ellipse: collects the half-width of every row, then emits outline and fill spans in one pass
+    inline bool txLinUnportableEllipseMidpointImplementation(int cx, int cy, int rx, int ry, HDC dc = txDC()) {
         if (dc == nullptr)
             return false;
-        int hh = TXLIN_UNPORTABLEDEF_SQUARE(height);
-        int ww = TXLIN_UNPORTABLEDEF_SQUARE(width);
-        int hhww = hh * ww;
-        int xz = width;
-        int dx = 0;
-#ifndef TXLIN_SPEED_OVER_FLOODFILL
-        for (int x = (width * (-1)); x <= width; x++) {
-            if (txGetFillColor() != TX_TRANSPARENT)
-                txSetPixel((int)(x0) + x, y0, txGetColor(), dc);
+        std::vector<int> halfWidths(ry + 2, -1);
+        long long rx2 = (long long)(rx) * rx;
+        long long ry2 = (long long)(ry) * ry;
+        long long x = 0;
+        long long y = ry;
+        if (ry == 0)
+            halfWidths[0] = rx;
+        else {
+            // all decision variables are scaled by 4 to stay in integers
+            long long px = 0;
+            long long py = 2 * rx2 * y;
+            long long p = 4 * ry2 - 4 * rx2 * ry + rx2;
+            while (px < py) {
+                halfWidths[y] = MAX(halfWidths[y], (int)(x));
+                x++;
+                px += 2 * ry2;
+                if (p < 0)
+                    p += 4 * (ry2 + px);
+                else {
+                    y--;
+                    py -= 2 * rx2;
+                    p += 4 * (ry2 + px - py);
+                }
+            }
+            p = ry2 * (2 * x + 1) * (2 * x + 1) + 4 * rx2 * (y - 1) * (y - 1) - 4 * rx2 * ry2;
+            while (y >= 0) {
+                halfWidths[y] = MAX(halfWidths[y], (int)(x));
+                y--;
+                py -= 2 * rx2;
+                if (p > 0)
+                    p += 4 * (rx2 - py);
+                else {
+                    x++;
+                    px += 2 * ry2;
+                    p += 4 * (rx2 - py + px);
+                }
+            }
         }
-#endif
 
-        // now do both halves at the same time, away from the diameter
-        for (int y = 1; y <= height; y++) {
-            int xa = xz - (dx - 1);  // try slopes of dx - 1 or more
-            for (; xa > 0; xa--)
-                if ((TXLIN_UNPORTABLEDEF_SQUARE(xa) * hh) + (TXLIN_UNPORTABLEDEF_SQUARE(y) * ww) <= hhww)
+        bool filled = (txGetFillColor() != TX_TRANSPARENT);
+        std::vector<SDL_Rect> outlineSpans;
+        std::vector<SDL_Rect> fillSpans;
+        for (int dy = 0; dy <= ry; dy++) {
+            int outer = halfWidths[dy];
+            // the outline reaches inwards to where the next row (further from the center) ends
+            int inner = MIN(outer, halfWidths[dy + 1] + 1);
+            for (int side = 0; side < 2; side++) {
+                if (side == 1 && dy == 0)
                     break;
-            dx = xz - xa;  // current approximation of the slope
-            xz = xa;
-
-            int xstart = x0 + (xz * (-1));
-            int xend = x0 + xz;
-
-#ifndef TXLIN_SPEED_OVER_FLOODFILL
-            if (txGetFillColor() == TX_TRANSPARENT) {
-#endif
-                txSetPixel(xstart, (int)(y0) - y, txGetColor(), dc);
-                txSetPixel(xstart, (int)(y0) + y, txGetColor(), dc);
-                txSetPixel(xend, (int)(y0) - y, txGetColor(), dc);
-                txSetPixel(xend, (int)(y0) + y, txGetColor(), dc);
-#ifndef TXLIN_SPEED_OVER_FLOODFILL
-            }
-            else {
-                for (int x = (xz * (-1)); x <= xz; x++) {
-                    txSetPixel((int)(x0) + x, (int)(y0) - y, txGetFillColor(), dc);
-                    txSetPixel((int)(x0) + x, (int)(y0) + y, txGetFillColor(), dc);
+                int row = (side == 0) ? cy + dy : cy - dy;
+                if (inner <= 0)
+                    txLinUnportableAddSpan(outlineSpans, cx - outer, cx + outer, row);
+                else {
+                    txLinUnportableAddSpan(outlineSpans, cx - outer, cx - inner, row);
+                    txLinUnportableAddSpan(outlineSpans, cx + inner, cx + outer, row);
+                    if (filled)
+                        txLinUnportableAddSpan(fillSpans, cx - inner + 1, cx + inner - 1, row);
                 }
             }
-#endif
         }
-        if (txLinUnportableAutomaticWindowUpdates)
-            txRedrawWindow();
+        txLinUnportableSubmitRects(dc, fillSpans, txGetFillColor());
+        txLinUnportableSubmitRects(dc, outlineSpans, txGetColor());
+        txLinUnportableCommitDrawing();
         return true;
     }
 
 #define txSticky() { txRedrawWindow(); txLinUnportableSDLEventLoop(); }
 
     bool txEllipse(double x0, double y0, double x1, double y1, HDC dc) {
+        TXLIN_UNPORTABLEDEF_STATSCOPE(TX_STAT_ELLIPSE);
         int height = txLinUnportableModule((int)(y1 - y0));
         int width = txLinUnportableModule((int)(x1 - x0));
-        int x0_new = (int)(x0) + (width / 2);
-        int y0_new = (int)(y0) + (height / 2);
-        return txLinUnportableEllipseClassicImplementation(x0_new, y0_new, width, height, dc);
+        int x0_new = (int)(MIN(x0, x1)) + (width / 2);
+        int y0_new = (int)(MIN(y0, y1)) + (height / 2);
+        return txLinUnportableEllipseMidpointImplementation(x0_new, y0_new, width / 2, height / 2, dc);
     }
 
     SIZE txGetTextExtent(const char* text, HDC dc) {
@@ -1508,8 +3602,43 @@ namespace TX {
         sizeOfText.cy = 0.0;
         if (dc == nullptr || text == nullptr)
             return sizeOfText;
-        sizeOfText.cx = (unsigned long)(strlen(text) * TXLIN_TEXTSET_MAXWIDTH);
-        sizeOfText.cy = (unsigned long)(TXLIN_TEXTSET_MAXHEIGHT);
+        TXTYPE_FONTCACHE* cachedFont = nullptr;
+        if (txLinUnportableUseMonolithic == false)
+            cachedFont = txLinUnportableGetFont(txLinUnportableFindFont(), TXLIN_TEXTSET_MAXHEIGHT);
+        int lines = 1;
+        int lineWidth = 0;
+        int maxWidth = 0;
+        if (cachedFont == nullptr) {
+            // same layout as the monolithic loop in txTextOut: every character takes MAXWIDTH + 1 pixels plus a gap of 2
+            int characters = 0;
+            for (const char* cursor = text; *cursor != '\0'; cursor++) {
+                if (*cursor == '\n') {
+                    lines++;
+                    characters = 0;
+                }
+                else {
+                    characters++;
+                    maxWidth = MAX(maxWidth, characters * (TXLIN_TEXTSET_MAXWIDTH + 3) - 2);
+                }
+            }
+            sizeOfText.cx = maxWidth;
+            sizeOfText.cy = lines * (TXLIN_TEXTSET_MAXHEIGHT + 3) - 2;
+            return sizeOfText;
+        }
+        const char* cursor = text;
+        while (*cursor != '\0') {
+            const char* sequence = cursor;
+            Uint32 codepoint = txLinUnportableDecodeUTF8(cursor);
+            if (codepoint == '\n') {
+                lines++;
+                lineWidth = 0;
+                continue;
+            }
+            lineWidth += txLinUnportableGlyphAdvance(cachedFont, sequence, (int)(cursor - sequence), codepoint);
+            maxWidth = MAX(maxWidth, lineWidth);
+        }
+        sizeOfText.cx = maxWidth;
+        sizeOfText.cy = TTF_FontHeight(cachedFont->font) + (lines - 1) * TTF_FontLineSkip(cachedFont->font);
         return sizeOfText;
     }
 
@@ -1521,11 +3650,6 @@ namespace TX {
         return txGetTextExtent(text, dc).cx;
     }
 
-    inline double txQueryPerformance() {
-        TXLIN_WARNING("txQueryPerformance() was kept in TXLin for compatibility purposes. It will always return a const value.");
-        return 2.7;
-    }
-
     inline POINT txMousePos() {
         int x = 1;
         int y = 1;
@@ -1551,6 +3675,31 @@ namespace TX {
         return (int)(txMousePos().y);
     }
 
+    // takes the oldest keyboard, mouse or window event that has not been read yet
+    inline bool txGetInputEvent(TXTYPE_INPUTEVENT* event) {
+        if (event == nullptr)
+            return false;
+        for (int attempt = 0; attempt < 2; attempt++) {
+#ifdef TXLIN_PTHREAD
+            pthread_mutex_lock(&txLinUnportableInputMutex);
+#endif
+            bool found = (txLinUnportableInputCount > 0);
+            if (found) {
+                *event = txLinUnportableInputEvents[txLinUnportableInputFirst];
+                txLinUnportableInputFirst = (txLinUnportableInputFirst + 1) % TXLIN_UNPORTABLEDEF_INPUTEVENTS;
+                txLinUnportableInputCount--;
+            }
+#ifdef TXLIN_PTHREAD
+            pthread_mutex_unlock(&txLinUnportableInputMutex);
+#endif
+            // nothing recorded yet, so ask SDL directly in case the program does not redraw the window
+            if (found || attempt > 0 || txLinUnportableOffMainThread())
+                return found;
+            txLinUnportableSDLProcessEvents();
+        }
+        return false;
+    }
+
     int txMessageBox(const char* text, const char* header, unsigned flags) {
         if (text == nullptr || header == nullptr)
             return IDCANCEL;
@@ -1909,50 +4058,958 @@ namespace TX {
         for (x = 0; x < 16; x++)
             printf ("%X",    x);
 
-        for (int y = 0; y < 16; y++, p += 16) {
-            txSetConsoleAttr (FOREGROUND_YELLOW);
-            printf ("\n" "%*p ", (int)(sizeof(address)) * 2, p);
-            int color = FOREGROUND_LIGHTGREEN;
-            for (x = 0; x < 16; x++) {
-                txSetConsoleAttr (color + x/4%2);
-                printf ("%02X ", p[x]);
+        for (int y = 0; y < 16; y++, p += 16) {
+            txSetConsoleAttr (FOREGROUND_YELLOW);
+            printf ("\n" "%*p ", (int)(sizeof(address)) * 2, p);
+            int color = FOREGROUND_LIGHTGREEN;
+            for (x = 0; x < 16; x++) {
+                txSetConsoleAttr (color + x/4%2);
+                printf ("%02X ", p[x]);
+            }
+            for (x = 0; x < 16; x++) {
+                txSetConsoleAttr (color + x/4%2);
+                printf ("%c", (isprint (p[x]) && !iscntrl (p[x]))? p[x] : '.');
+            }
+        }
+        txSetConsoleAttr(attr);
+        printf ("\n");
+    }
+
+#ifdef TXLIN_PTHREAD
+    inline pthread_mutex_t* txLinUnportableDCLock(HDC dc, bool create = true) {
+        pthread_mutex_lock(&txLinUnportableLockTableMutex);
+        pthread_mutex_t* result = nullptr;
+        std::unordered_map<HDC, pthread_mutex_t*>::iterator found = txLinUnportableDCLocks.find(dc);
+        if (found != txLinUnportableDCLocks.end())
+            result = found->second;
+        else if (create) {
+            // recursive like the critical section of TXLib, so nested txLock calls in one thread are fine
+            result = new pthread_mutex_t;
+            pthread_mutexattr_t attributes;
+            pthread_mutexattr_init(&attributes);
+            pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+            pthread_mutex_init(result, &attributes);
+            pthread_mutexattr_destroy(&attributes);
+            txLinUnportableDCLocks[dc] = result;
+        }
+        pthread_mutex_unlock(&txLinUnportableLockTableMutex);
+        return result;
+    }
+
+    inline void txLinUnportableDestroyDCLock(HDC dc) {
+        pthread_mutex_lock(&txLinUnportableLockTableMutex);
+        std::unordered_map<HDC, pthread_mutex_t*>::iterator found = txLinUnportableDCLocks.find(dc);
+        if (found != txLinUnportableDCLocks.end()) {
+            pthread_mutex_destroy(found->second);
+            delete found->second;
+            txLinUnportableDCLocks.erase(found);
+        }
+        pthread_mutex_unlock(&txLinUnportableLockTableMutex);
+    }
+#endif
+
+    inline bool txLock(bool wait = true, HDC dc = txDC()) {
+        if (dc == nullptr)
+            return false;
+#ifdef TXLIN_PTHREAD
+        pthread_mutex_t* mutex = txLinUnportableDCLock(dc);
+        if (pthread_mutex_trylock(mutex) != 0) {
+            if (wait == false || pthread_mutex_lock(mutex) != 0)
+                return false;
+        }
+#else
+        // without threads nobody else can hold the lock
+        (void)(wait);
+#endif
+        txLinUnportableHeldLocks++;
+        return true;
+    }
+
+    inline bool txUnlock(HDC dc = txDC()) {
+        if (dc == nullptr || txLinUnportableHeldLocks <= 0)
+            return false;
+#ifdef TXLIN_PTHREAD
+        pthread_mutex_t* mutex = txLinUnportableDCLock(dc, false);
+        if (mutex == nullptr || pthread_mutex_unlock(mutex) != 0)
+            return false;
+#endif
+        if (--txLinUnportableHeldLocks == 0)
+            txLinUnportableCommitDrawing();
+        return true;
+    }
+
+    inline std::vector<Uint32> txLinUnportableCRCTable() {
+        std::vector<Uint32> table(256);
+        for (Uint32 n = 0; n < 256; n++) {
+            Uint32 c = n;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        return table;
+    }
+
+    inline Uint32 txLinUnportableCRC32(const Uint8* data, size_t size, Uint32 crc = 0) {
+        static const std::vector<Uint32> table = txLinUnportableCRCTable();
+        crc = ~crc;
+        for (size_t i = 0; i < size; i++)
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    inline Uint32 txLinUnportableAdler32(const Uint8* data, size_t size) {
+        Uint32 a = 1;
+        Uint32 b = 0;
+        while (size > 0) {
+            // 5552 bytes is the most that can be summed before b overflows
+            size_t block = MIN(size, (size_t)(5552));
+            for (size_t i = 0; i < block; i++) {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+            data += block;
+            size -= block;
+        }
+        return (b << 16) | a;
+    }
+
+    inline void txLinUnportablePutBits(std::vector<Uint8>& output, Uint64& buffer, int& count, Uint32 bits, int length) {
+        buffer |= (Uint64)(bits) << count;
+        count += length;
+        while (count >= 8) {
+            output.push_back((Uint8)(buffer));
+            buffer >>= 8;
+            count -= 8;
+        }
+    }
+
+    // deflate writes Huffman codes starting from the most significant bit
+    inline Uint32 txLinUnportableReverseBits(Uint32 code, int length) {
+        Uint32 result = 0;
+        for (int i = 0; i < length; i++) {
+            result = (result << 1) | (code & 1);
+            code >>= 1;
+        }
+        return result;
+    }
+
+    static const Uint16 txLinUnportableLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static const Uint8 txLinUnportableLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static const Uint16 txLinUnportableDistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    static const Uint8 txLinUnportableDistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    inline void txLinUnportablePutFixedLiteral(std::vector<Uint8>& output, Uint64& buffer, int& count, int symbol) {
+        if (symbol < 144)
+            txLinUnportablePutBits(output, buffer, count, txLinUnportableReverseBits(0x30 + symbol, 8), 8);
+        else if (symbol < 256)
+            txLinUnportablePutBits(output, buffer, count, txLinUnportableReverseBits(0x190 + symbol - 144, 9), 9);
+        else if (symbol < 280)
+            txLinUnportablePutBits(output, buffer, count, txLinUnportableReverseBits(symbol - 256, 7), 7);
+        else
+            txLinUnportablePutBits(output, buffer, count, txLinUnportableReverseBits(0xC0 + symbol - 280, 8), 8);
+    }
+
+    // zlib stream with one fixed-Huffman block; greedy LZ77 with a single hash probe is enough
+    // for drawings, where filtered rows are mostly long runs of the same bytes
+    inline void txLinUnportableDeflate(const Uint8* data, size_t size, std::vector<Uint8>& output) {
+        const int hashBits = 15;
+        std::vector<int> head((size_t)(1) << hashBits, -1);
+        Uint64 buffer = 0;
+        int count = 0;
+        output.push_back(0x78);
+        output.push_back(0x01);
+        // final block, fixed codes
+        txLinUnportablePutBits(output, buffer, count, 3, 3);
+        size_t i = 0;
+        while (i < size) {
+            size_t matchLength = 0;
+            size_t matchDistance = 0;
+            if (i + 3 <= size) {
+                Uint32 hash = (((Uint32)(data[i]) << 16 | (Uint32)(data[i + 1]) << 8 | data[i + 2]) * 2654435761u) >> (32 - hashBits);
+                int candidate = head[hash];
+                head[hash] = (int)(i);
+                if (candidate >= 0 && i - candidate <= 32768) {
+                    size_t limit = MIN(size - i, (size_t)(258));
+                    const Uint8* earlier = data + candidate;
+                    const Uint8* current = data + i;
+                    size_t length = 0;
+                    while (length < limit && earlier[length] == current[length])
+                        length++;
+                    if (length >= 3) {
+                        matchLength = length;
+                        matchDistance = i - candidate;
+                    }
+                }
+            }
+            if (matchLength == 0) {
+                txLinUnportablePutFixedLiteral(output, buffer, count, data[i]);
+                i++;
+                continue;
+            }
+            int code = 28;
+            while (txLinUnportableLengthBase[code] > matchLength)
+                code--;
+            txLinUnportablePutFixedLiteral(output, buffer, count, 257 + code);
+            txLinUnportablePutBits(output, buffer, count, (Uint32)(matchLength - txLinUnportableLengthBase[code]), txLinUnportableLengthExtra[code]);
+            code = 29;
+            while (txLinUnportableDistanceBase[code] > matchDistance)
+                code--;
+            txLinUnportablePutBits(output, buffer, count, txLinUnportableReverseBits(code, 5), 5);
+            txLinUnportablePutBits(output, buffer, count, (Uint32)(matchDistance - txLinUnportableDistanceBase[code]), txLinUnportableDistanceExtra[code]);
+            // positions inside short matches are hashed too, long ones are runs that the next probe finds anyway
+            size_t end = i + matchLength;
+            if (matchLength < 32) {
+                for (size_t j = i + 1; j + 3 <= size && j < end; j++)
+                    head[(((Uint32)(data[j]) << 16 | (Uint32)(data[j + 1]) << 8 | data[j + 2]) * 2654435761u) >> (32 - hashBits)] = (int)(j);
+            }
+            i = end;
+        }
+        txLinUnportablePutFixedLiteral(output, buffer, count, 256);
+        if (count > 0)
+            output.push_back((Uint8)(buffer));
+        Uint32 adler = txLinUnportableAdler32(data, size);
+        for (int shift = 24; shift >= 0; shift -= 8)
+            output.push_back((Uint8)(adler >> shift));
+    }
+
+    inline Uint32 txLinUnportableInflateBits(TXTYPE_INFLATESTATE& state, int need) {
+        while (state.bitCount < need) {
+            if (state.position >= state.size) {
+                state.error = true;
+                return 0;
+            }
+            state.bitBuffer |= (Uint32)(state.data[state.position++]) << state.bitCount;
+            state.bitCount += 8;
+        }
+        Uint32 value = state.bitBuffer & ((1u << need) - 1);
+        state.bitBuffer >>= need;
+        state.bitCount -= need;
+        return value;
+    }
+
+    inline bool txLinUnportableBuildHuffman(TXTYPE_HUFFMAN& huffman, const Uint8* lengths, int count) {
+        Uint16 offsets[16];
+        memset(huffman.counts, 0, sizeof(huffman.counts));
+        for (int symbol = 0; symbol < count; symbol++)
+            huffman.counts[lengths[symbol]]++;
+        int left = 1;
+        for (int length = 1; length < 16; length++) {
+            left = (left << 1) - huffman.counts[length];
+            if (left < 0)
+                return false;
+        }
+        offsets[1] = 0;
+        for (int length = 1; length < 15; length++)
+            offsets[length + 1] = offsets[length] + huffman.counts[length];
+        for (int symbol = 0; symbol < count; symbol++) {
+            if (lengths[symbol] != 0)
+                huffman.symbols[offsets[lengths[symbol]]++] = (Uint16)(symbol);
+        }
+        return true;
+    }
+
+    inline int txLinUnportableInflateSymbol(TXTYPE_INFLATESTATE& state, const TXTYPE_HUFFMAN& huffman) {
+        int code = 0;
+        int first = 0;
+        int index = 0;
+        for (int length = 1; length < 16; length++) {
+            code |= (int)(txLinUnportableInflateBits(state, 1));
+            int count = huffman.counts[length];
+            if (code - count < first)
+                return huffman.symbols[index + (code - first)];
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+            if (state.error)
+                return -1;
+        }
+        state.error = true;
+        return -1;
+    }
+
+    inline bool txLinUnportableInflateCodes(TXTYPE_INFLATESTATE& state, const TXTYPE_HUFFMAN& lengthCode, const TXTYPE_HUFFMAN& distanceCode, std::vector<Uint8>& output, size_t limit) {
+        while (state.error == false) {
+            int symbol = txLinUnportableInflateSymbol(state, lengthCode);
+            if (symbol < 0)
+                return false;
+            if (symbol < 256) {
+                if (output.size() >= limit)
+                    return false;
+                output.push_back((Uint8)(symbol));
+                continue;
+            }
+            if (symbol == 256)
+                return true;
+            symbol -= 257;
+            if (symbol >= 29)
+                return false;
+            size_t length = txLinUnportableLengthBase[symbol] + txLinUnportableInflateBits(state, txLinUnportableLengthExtra[symbol]);
+            symbol = txLinUnportableInflateSymbol(state, distanceCode);
+            if (symbol < 0 || symbol >= 30)
+                return false;
+            size_t distance = txLinUnportableDistanceBase[symbol] + txLinUnportableInflateBits(state, txLinUnportableDistanceExtra[symbol]);
+            if (distance > output.size() || length > limit - output.size())
+                return false;
+            size_t from = output.size() - distance;
+            for (size_t i = 0; i < length; i++)
+                output.push_back(output[from + i]);
+        }
+        return false;
+    }
+
+    // zlib stream to bytes; any deflate stream is accepted, not only the ones txLinUnportableDeflate writes;
+    // a stream that would grow past limit bytes fails right away, so a small file cannot take all the memory
+    inline bool txLinUnportableInflate(const Uint8* data, size_t size, std::vector<Uint8>& output, size_t limit) {
+        if (size < 2 || (data[0] & 0x0F) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20) != 0)
+            return false;
+        TXTYPE_INFLATESTATE state = { data, size, 2, 0, 0, false };
+        bool last = false;
+        while (last == false) {
+            last = (txLinUnportableInflateBits(state, 1) == 1);
+            Uint32 type = txLinUnportableInflateBits(state, 2);
+            if (state.error)
+                return false;
+            if (type == 0) {
+                // stored blocks start at a byte boundary
+                state.bitBuffer = 0;
+                state.bitCount = 0;
+                if (state.position + 4 > state.size)
+                    return false;
+                size_t length = data[state.position] | (data[state.position + 1] << 8);
+                size_t check = data[state.position + 2] | (data[state.position + 3] << 8);
+                state.position += 4;
+                if (length != (~check & 0xFFFF) || state.position + length > state.size || length > limit - output.size())
+                    return false;
+                output.insert(output.end(), data + state.position, data + state.position + length);
+                state.position += length;
+                continue;
+            }
+            TXTYPE_HUFFMAN lengthCode;
+            TXTYPE_HUFFMAN distanceCode;
+            Uint8 lengths[320];
+            if (type == 1) {
+                for (int symbol = 0; symbol < 288; symbol++)
+                    lengths[symbol] = (symbol < 144) ? 8 : (symbol < 256) ? 9 : (symbol < 280) ? 7 : 8;
+                txLinUnportableBuildHuffman(lengthCode, lengths, 288);
+                for (int symbol = 0; symbol < 30; symbol++)
+                    lengths[symbol] = 5;
+                txLinUnportableBuildHuffman(distanceCode, lengths, 30);
+            }
+            else if (type == 2) {
+                static const Uint8 order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+                int lengthCount = (int)(txLinUnportableInflateBits(state, 5)) + 257;
+                int distanceCount = (int)(txLinUnportableInflateBits(state, 5)) + 1;
+                int codeCount = (int)(txLinUnportableInflateBits(state, 4)) + 4;
+                if (lengthCount > 286 || distanceCount > 30)
+                    return false;
+                memset(lengths, 0, sizeof(lengths));
+                for (int i = 0; i < codeCount; i++)
+                    lengths[order[i]] = (Uint8)(txLinUnportableInflateBits(state, 3));
+                TXTYPE_HUFFMAN codeLengthCode;
+                if (state.error || txLinUnportableBuildHuffman(codeLengthCode, lengths, 19) == false)
+                    return false;
+                int index = 0;
+                while (index < lengthCount + distanceCount) {
+                    int symbol = txLinUnportableInflateSymbol(state, codeLengthCode);
+                    if (symbol < 0)
+                        return false;
+                    if (symbol < 16) {
+                        lengths[index++] = (Uint8)(symbol);
+                        continue;
+                    }
+                    Uint8 repeated = 0;
+                    int times = 0;
+                    if (symbol == 16) {
+                        if (index == 0)
+                            return false;
+                        repeated = lengths[index - 1];
+                        times = 3 + (int)(txLinUnportableInflateBits(state, 2));
+                    }
+                    else if (symbol == 17)
+                        times = 3 + (int)(txLinUnportableInflateBits(state, 3));
+                    else
+                        times = 11 + (int)(txLinUnportableInflateBits(state, 7));
+                    if (index + times > lengthCount + distanceCount)
+                        return false;
+                    while (times-- > 0)
+                        lengths[index++] = repeated;
+                }
+                if (lengths[256] == 0 || txLinUnportableBuildHuffman(lengthCode, lengths, lengthCount) == false || txLinUnportableBuildHuffman(distanceCode, lengths + lengthCount, distanceCount) == false)
+                    return false;
+            }
+            else
+                return false;
+            if (txLinUnportableInflateCodes(state, lengthCode, distanceCode, output, limit) == false)
+                return false;
+        }
+        return true;
+    }
+
+    inline void txLinUnportablePutBigEndian(std::vector<Uint8>& output, Uint32 value) {
+        for (int shift = 24; shift >= 0; shift -= 8)
+            output.push_back((Uint8)(value >> shift));
+    }
+
+    inline Uint32 txLinUnportableGetBigEndian(const Uint8* data) {
+        return ((Uint32)(data[0]) << 24) | ((Uint32)(data[1]) << 16) | ((Uint32)(data[2]) << 8) | data[3];
+    }
+
+    inline void txLinUnportablePutChunk(std::vector<Uint8>& output, const char* type, const std::vector<Uint8>& chunk) {
+        txLinUnportablePutBigEndian(output, (Uint32)(chunk.size()));
+        size_t start = output.size();
+        output.insert(output.end(), type, type + 4);
+        output.insert(output.end(), chunk.begin(), chunk.end());
+        txLinUnportablePutBigEndian(output, txLinUnportableCRC32(&(output[start]), output.size() - start));
+    }
+
+    inline int txLinUnportablePaeth(int a, int b, int c) {
+        int p = a + b - c;
+        int pa = abs(p - a);
+        int pb = abs(p - b);
+        int pc = abs(p - c);
+        if (pa <= pb && pa <= pc)
+            return a;
+        return (pb <= pc) ? b : c;
+    }
+
+    // pixels are 0xAARRGGBB with straight alpha; without alpha an RGB image is written
+    inline bool txLinUnportableEncodePNG(const std::vector<Uint32>& pixels, int width, int height, bool alpha, std::vector<Uint8>& output) {
+        int channels = (alpha) ? 4 : 3;
+        size_t stride = (size_t)(width) * channels;
+        std::vector<Uint8> raw(stride);
+        std::vector<Uint8> previous(stride, 0);
+        std::vector<Uint8> filtered((stride + 1) * height);
+        for (int y = 0; y < height; y++) {
+            const Uint32* row = &(pixels[(size_t)(y) * width]);
+            for (int x = 0; x < width; x++) {
+                Uint8* pixel = &(raw[(size_t)(x) * channels]);
+                pixel[0] = (Uint8)(row[x] >> 16);
+                pixel[1] = (Uint8)(row[x] >> 8);
+                pixel[2] = (Uint8)(row[x]);
+                if (alpha)
+                    pixel[3] = (Uint8)(row[x] >> 24);
+            }
+            // of Sub and Up, the filter with the smaller sum usually compresses better
+            Uint8* out = &(filtered[(stride + 1) * y]);
+            Uint32 subSum = 0;
+            Uint32 upSum = 0;
+            for (size_t i = 0; i < stride; i++) {
+                Uint8 sub = raw[i] - ((i >= (size_t)(channels)) ? raw[i - channels] : 0);
+                Uint8 up = raw[i] - previous[i];
+                subSum += (sub < 128) ? sub : 256 - sub;
+                upSum += (up < 128) ? up : 256 - up;
+            }
+            bool useUp = (y > 0 && upSum < subSum);
+            out[0] = (useUp) ? 2 : 1;
+            for (size_t i = 0; i < stride; i++)
+                out[i + 1] = (useUp) ? (Uint8)(raw[i] - previous[i]) : (Uint8)(raw[i] - ((i >= (size_t)(channels)) ? raw[i - channels] : 0));
+            previous.swap(raw);
+        }
+        static const Uint8 signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        output.assign(signature, signature + 8);
+        std::vector<Uint8> chunk;
+        txLinUnportablePutBigEndian(chunk, (Uint32)(width));
+        txLinUnportablePutBigEndian(chunk, (Uint32)(height));
+        Uint8 header[5] = { 8, (Uint8)((alpha) ? 6 : 2), 0, 0, 0 };
+        chunk.insert(chunk.end(), header, header + 5);
+        txLinUnportablePutChunk(output, "IHDR", chunk);
+        chunk.clear();
+        txLinUnportableDeflate(&(filtered[0]), filtered.size(), chunk);
+        txLinUnportablePutChunk(output, "IDAT", chunk);
+        chunk.clear();
+        txLinUnportablePutChunk(output, "IEND", chunk);
+        return true;
+    }
+
+    // any non-animated PNG: all color types and bit depths, with or without interlacing
+    inline bool txLinUnportableDecodePNG(const Uint8* data, size_t size, std::vector<Uint32>& pixels, int* width, int* height) {
+        static const Uint8 signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        if (size < 8 || memcmp(data, signature, 8) != 0)
+            return false;
+        Uint32 w = 0;
+        Uint32 h = 0;
+        int depth = 0;
+        int colorType = -1;
+        int interlace = 0;
+        std::vector<Uint8> compressed;
+        Uint8 palette[256][4];
+        int paletteSize = 0;
+        std::vector<Uint8> transparency;
+        size_t position = 8;
+        while (position + 12 <= size) {
+            Uint32 length = txLinUnportableGetBigEndian(data + position);
+            const Uint8* type = data + position + 4;
+            const Uint8* chunk = data + position + 8;
+            if (length > size - position - 12)
+                return false;
+            if (memcmp(type, "IHDR", 4) == 0 && length >= 13) {
+                w = txLinUnportableGetBigEndian(chunk);
+                h = txLinUnportableGetBigEndian(chunk + 4);
+                depth = chunk[8];
+                colorType = chunk[9];
+                interlace = chunk[12];
+            }
+            else if (memcmp(type, "PLTE", 4) == 0) {
+                paletteSize = (int)(MIN(length / 3, (Uint32)(256)));
+                for (int i = 0; i < paletteSize; i++) {
+                    palette[i][0] = chunk[i * 3];
+                    palette[i][1] = chunk[i * 3 + 1];
+                    palette[i][2] = chunk[i * 3 + 2];
+                }
+            }
+            else if (memcmp(type, "tRNS", 4) == 0)
+                transparency.assign(chunk, chunk + length);
+            else if (memcmp(type, "IDAT", 4) == 0)
+                compressed.insert(compressed.end(), chunk, chunk + length);
+            else if (memcmp(type, "IEND", 4) == 0)
+                break;
+            position += 12 + length;
+        }
+        int channels = (colorType == 0 || colorType == 3) ? 1 : (colorType == 2) ? 3 : (colorType == 4) ? 2 : (colorType == 6) ? 4 : 0;
+        bool validDepth = (depth == 8 || (depth == 16 && colorType != 3) || ((depth == 1 || depth == 2 || depth == 4) && (colorType == 0 || colorType == 3)));
+        if (channels == 0 || validDepth == false || w == 0 || h == 0 || (Uint64)(w) * h > TXLIN_UNPORTABLEDEF_MAXIMAGEPIXELS || interlace > 1)
+            return false;
+        int bitsPerPixel = channels * depth;
+        static const int startX[7] = { 0, 4, 0, 2, 0, 1, 0 };
+        static const int startY[7] = { 0, 0, 4, 0, 2, 0, 1 };
+        static const int stepX[7] = { 8, 8, 4, 4, 2, 2, 1 };
+        static const int stepY[7] = { 8, 8, 8, 4, 4, 2, 2 };
+        // the exact size of the filtered rows of all passes, nothing more may come out of the stream
+        size_t rawSize = 0;
+        for (int pass = 0; pass < ((interlace) ? 7 : 1); pass++) {
+            int x0 = (interlace) ? startX[pass] : 0;
+            int y0 = (interlace) ? startY[pass] : 0;
+            int dx = (interlace) ? stepX[pass] : 1;
+            int dy = (interlace) ? stepY[pass] : 1;
+            if ((int)(w) <= x0 || (int)(h) <= y0)
+                continue;
+            size_t passWidth = (w - x0 + dx - 1) / dx;
+            size_t passHeight = (h - y0 + dy - 1) / dy;
+            rawSize += passHeight * (1 + (passWidth * bitsPerPixel + 7) / 8);
+        }
+        std::vector<Uint8> raw;
+        raw.reserve(rawSize);
+        if (txLinUnportableInflate(compressed.empty() ? nullptr : &(compressed[0]), compressed.size(), raw, rawSize) == false) {
+            TXLIN_WARNING("PNG image data is damaged");
+            return false;
+        }
+        for (int i = 0; i < paletteSize; i++)
+            palette[i][3] = (i < (int)(transparency.size())) ? transparency[i] : 255;
+        int key[3] = { -1, -1, -1 };
+        if (colorType == 0 && transparency.size() >= 2)
+            key[0] = (transparency[0] << 8) | transparency[1];
+        if (colorType == 2 && transparency.size() >= 6) {
+            for (int c = 0; c < 3; c++)
+                key[c] = (transparency[c * 2] << 8) | transparency[c * 2 + 1];
+        }
+        pixels.assign((size_t)(w) * h, 0);
+        int filterStep = MAX(1, bitsPerPixel / 8);
+        size_t offset = 0;
+        for (int pass = 0; pass < ((interlace) ? 7 : 1); pass++) {
+            int x0 = (interlace) ? startX[pass] : 0;
+            int y0 = (interlace) ? startY[pass] : 0;
+            int dx = (interlace) ? stepX[pass] : 1;
+            int dy = (interlace) ? stepY[pass] : 1;
+            if ((int)(w) <= x0 || (int)(h) <= y0)
+                continue;
+            size_t passWidth = (w - x0 + dx - 1) / dx;
+            size_t passHeight = (h - y0 + dy - 1) / dy;
+            size_t stride = (passWidth * bitsPerPixel + 7) / 8;
+            std::vector<Uint8> previous(stride, 0);
+            for (size_t row = 0; row < passHeight; row++) {
+                if (offset + 1 + stride > raw.size())
+                    return false;
+                int filter = raw[offset];
+                Uint8* line = &(raw[offset + 1]);
+                offset += 1 + stride;
+                for (size_t i = 0; i < stride; i++) {
+                    int left = (i >= (size_t)(filterStep)) ? line[i - filterStep] : 0;
+                    int upLeft = (i >= (size_t)(filterStep)) ? previous[i - filterStep] : 0;
+                    if (filter == 1)
+                        line[i] += left;
+                    else if (filter == 2)
+                        line[i] += previous[i];
+                    else if (filter == 3)
+                        line[i] += (left + previous[i]) / 2;
+                    else if (filter == 4)
+                        line[i] += txLinUnportablePaeth(left, previous[i], upLeft);
+                    else if (filter != 0)
+                        return false;
+                }
+                memcpy(&(previous[0]), line, stride);
+                for (size_t column = 0; column < passWidth; column++) {
+                    int values[4];
+                    for (int c = 0; c < channels; c++) {
+                        size_t sample = column * channels + c;
+                        if (depth == 16)
+                            values[c] = (line[sample * 2] << 8) | line[sample * 2 + 1];
+                        else if (depth == 8)
+                            values[c] = line[sample];
+                        else {
+                            size_t bit = sample * depth;
+                            values[c] = (line[bit / 8] >> (8 - depth - bit % 8)) & ((1 << depth) - 1);
+                        }
+                    }
+                    Uint32 r = 0;
+                    Uint32 g = 0;
+                    Uint32 b = 0;
+                    Uint32 a = 255;
+                    // samples of other depths are stretched to 0..255, 16-bit ones keep their high byte
+                    int scaled[4];
+                    for (int c = 0; c < channels; c++)
+                        scaled[c] = (depth == 16) ? values[c] >> 8 : values[c] * 255 / ((1 << depth) - 1);
+                    if (colorType == 3) {
+                        if (values[0] >= paletteSize)
+                            return false;
+                        r = palette[values[0]][0];
+                        g = palette[values[0]][1];
+                        b = palette[values[0]][2];
+                        a = palette[values[0]][3];
+                    }
+                    else if (colorType == 0 || colorType == 4) {
+                        r = g = b = scaled[0];
+                        if (colorType == 4)
+                            a = scaled[1];
+                        else if (values[0] == key[0])
+                            a = 0;
+                    }
+                    else {
+                        r = scaled[0];
+                        g = scaled[1];
+                        b = scaled[2];
+                        if (colorType == 6)
+                            a = scaled[3];
+                        else if (values[0] == key[0] && values[1] == key[1] && values[2] == key[2])
+                            a = 0;
+                    }
+                    pixels[(y0 + row * dy) * w + x0 + column * dx] = (a << 24) | (r << 16) | (g << 8) | b;
+                }
+            }
+        }
+        *width = (int)(w);
+        *height = (int)(h);
+        return true;
+    }
+
+    inline int txLinUnportableQOIHash(Uint32 pixel) {
+        return (int)((((pixel >> 16) & 0xFF) * 3 + ((pixel >> 8) & 0xFF) * 5 + (pixel & 0xFF) * 7 + (pixel >> 24) * 11) % 64);
+    }
+
+    inline bool txLinUnportableEncodeQOI(const std::vector<Uint32>& pixels, int width, int height, bool alpha, std::vector<Uint8>& output) {
+        output.clear();
+        output.reserve((size_t)(width) * height * 2 + 22);
+        output.push_back('q');
+        output.push_back('o');
+        output.push_back('i');
+        output.push_back('f');
+        txLinUnportablePutBigEndian(output, (Uint32)(width));
+        txLinUnportablePutBigEndian(output, (Uint32)(height));
+        output.push_back((alpha) ? 4 : 3);
+        output.push_back(0);
+        Uint32 seen[64];
+        memset(seen, 0, sizeof(seen));
+        Uint32 last = 0xFF000000u;
+        int run = 0;
+        size_t count = (size_t)(width) * height;
+        for (size_t i = 0; i < count; i++) {
+            Uint32 pixel = (alpha) ? pixels[i] : (pixels[i] | 0xFF000000u);
+            if (pixel == last) {
+                run++;
+                if (run == 62 || i + 1 == count) {
+                    output.push_back((Uint8)(0xC0 | (run - 1)));
+                    run = 0;
+                }
+                continue;
             }
-            for (x = 0; x < 16; x++) {
-                txSetConsoleAttr (color + x/4%2);
-                printf ("%c", (isprint (p[x]) && !iscntrl (p[x]))? p[x] : '.');
+            if (run > 0) {
+                output.push_back((Uint8)(0xC0 | (run - 1)));
+                run = 0;
+            }
+            int hash = txLinUnportableQOIHash(pixel);
+            if (seen[hash] == pixel)
+                output.push_back((Uint8)(hash));
+            else {
+                seen[hash] = pixel;
+                if ((pixel >> 24) == (last >> 24)) {
+                    int dr = (int)((pixel >> 16) & 0xFF) - (int)((last >> 16) & 0xFF);
+                    int dg = (int)((pixel >> 8) & 0xFF) - (int)((last >> 8) & 0xFF);
+                    int db = (int)(pixel & 0xFF) - (int)(last & 0xFF);
+                    // channel differences wrap around like bytes
+                    dr = (Sint8)(dr);
+                    dg = (Sint8)(dg);
+                    db = (Sint8)(db);
+                    int drg = dr - dg;
+                    int dbg = db - dg;
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+                        output.push_back((Uint8)(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                    else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+                        output.push_back((Uint8)(0x80 | (dg + 32)));
+                        output.push_back((Uint8)((drg + 8) << 4 | (dbg + 8)));
+                    }
+                    else {
+                        output.push_back(0xFE);
+                        output.push_back((Uint8)(pixel >> 16));
+                        output.push_back((Uint8)(pixel >> 8));
+                        output.push_back((Uint8)(pixel));
+                    }
+                }
+                else {
+                    output.push_back(0xFF);
+                    output.push_back((Uint8)(pixel >> 16));
+                    output.push_back((Uint8)(pixel >> 8));
+                    output.push_back((Uint8)(pixel));
+                    output.push_back((Uint8)(pixel >> 24));
+                }
             }
+            last = pixel;
         }
-        txSetConsoleAttr(attr);
-        printf ("\n");
+        for (int i = 0; i < 7; i++)
+            output.push_back(0);
+        output.push_back(1);
+        return true;
     }
 
-    inline bool txLock(bool wait = true) {
-        (void)(wait);
-        TXLIN_WARNING("txLock(bool wait) is kept in TXLin for compatibility purposes and does nothing.");
-        return false;
+    inline bool txLinUnportableDecodeQOI(const Uint8* data, size_t size, std::vector<Uint32>& pixels, int* width, int* height) {
+        if (size < 22 || memcmp(data, "qoif", 4) != 0)
+            return false;
+        Uint32 w = txLinUnportableGetBigEndian(data + 4);
+        Uint32 h = txLinUnportableGetBigEndian(data + 8);
+        if (w == 0 || h == 0 || (Uint64)(w) * h > TXLIN_UNPORTABLEDEF_MAXIMAGEPIXELS)
+            return false;
+        size_t count = (size_t)(w) * h;
+        pixels.assign(count, 0);
+        Uint32 seen[64];
+        memset(seen, 0, sizeof(seen));
+        Uint32 pixel = 0xFF000000u;
+        size_t position = 14;
+        size_t end = size - 8;
+        int run = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (run > 0)
+                run--;
+            else if (position < end) {
+                Uint8 op = data[position++];
+                // the 8-bit tags come first, a truncated one must not be taken for a run
+                if (op == 0xFE) {
+                    if (position + 3 > end)
+                        return false;
+                    pixel = (pixel & 0xFF000000u) | ((Uint32)(data[position]) << 16) | ((Uint32)(data[position + 1]) << 8) | data[position + 2];
+                    position += 3;
+                }
+                else if (op == 0xFF) {
+                    if (position + 4 > end)
+                        return false;
+                    pixel = ((Uint32)(data[position + 3]) << 24) | ((Uint32)(data[position]) << 16) | ((Uint32)(data[position + 1]) << 8) | data[position + 2];
+                    position += 4;
+                }
+                else if ((op & 0xC0) == 0x00)
+                    pixel = seen[op];
+                else if ((op & 0xC0) == 0x40) {
+                    Uint32 r = (((pixel >> 16) & 0xFF) + ((op >> 4) & 3) - 2) & 0xFF;
+                    Uint32 g = (((pixel >> 8) & 0xFF) + ((op >> 2) & 3) - 2) & 0xFF;
+                    Uint32 b = ((pixel & 0xFF) + (op & 3) - 2) & 0xFF;
+                    pixel = (pixel & 0xFF000000u) | (r << 16) | (g << 8) | b;
+                }
+                else if ((op & 0xC0) == 0x80) {
+                    if (position >= end)
+                        return false;
+                    int dg = (op & 0x3F) - 32;
+                    Uint8 next = data[position++];
+                    Uint32 r = (((pixel >> 16) & 0xFF) + dg - 8 + ((next >> 4) & 0x0F)) & 0xFF;
+                    Uint32 g = (((pixel >> 8) & 0xFF) + dg) & 0xFF;
+                    Uint32 b = ((pixel & 0xFF) + dg - 8 + (next & 0x0F)) & 0xFF;
+                    pixel = (pixel & 0xFF000000u) | (r << 16) | (g << 8) | b;
+                }
+                else
+                    run = op & 0x3F;
+                seen[txLinUnportableQOIHash(pixel)] = pixel;
+            }
+            else
+                return false;
+            pixels[i] = pixel;
+        }
+        *width = (int)(w);
+        *height = (int)(h);
+        return true;
     }
 
-    inline bool txUnlock() {
-        TXLIN_WARNING("txUnlock() is kept in TXLin for compatibility purposes and does nothing.");
-        return false;
+    // the pixels of a surface as 0xAARRGGBB with straight alpha; alpha is reported only if the surface has it
+    inline bool txLinUnportableSurfaceToARGB(SDL_Surface* surface, std::vector<Uint32>& pixels, bool* alpha) {
+        if (surface == nullptr || surface->pixels == nullptr)
+            return false;
+        if (surface->format->BytesPerPixel != 4) {
+            SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+            if (converted == nullptr)
+                return false;
+            bool result = txLinUnportableSurfaceToARGB(converted, pixels, alpha);
+            SDL_FreeSurface(converted);
+            return result;
+        }
+        const SDL_PixelFormat* fmt = surface->format;
+        *alpha = (fmt->Amask != 0);
+        pixels.resize((size_t)(surface->w) * surface->h);
+        for (int y = 0; y < surface->h; y++) {
+            const Uint32* row = (const Uint32*)((const Uint8*)(surface->pixels) + y * surface->pitch);
+            Uint32* out = &(pixels[(size_t)(y) * surface->w]);
+            for (int x = 0; x < surface->w; x++) {
+                Uint32 r = (row[x] & fmt->Rmask) >> fmt->Rshift;
+                Uint32 g = (row[x] & fmt->Gmask) >> fmt->Gshift;
+                Uint32 b = (row[x] & fmt->Bmask) >> fmt->Bshift;
+                Uint32 a = (*alpha) ? (row[x] & fmt->Amask) >> fmt->Ashift : 255;
+                // DCs with alpha hold it premultiplied, like the ones txAlphaBlend expects
+                if (*alpha && a > 0 && a < 255) {
+                    r = MIN(r * 255 / a, (Uint32)(255));
+                    g = MIN(g * 255 / a, (Uint32)(255));
+                    b = MIN(b * 255 / a, (Uint32)(255));
+                }
+                out[x] = (a << 24) | (r << 16) | (g << 8) | b;
+            }
+        }
+        return true;
+    }
+
+    inline std::string txLinUnportableImageExtension(const char* filename) {
+        const char* dot = strrchr(filename, '.');
+        std::string extension = (dot != nullptr) ? dot + 1 : "";
+        for (size_t i = 0; i < extension.size(); i++)
+            extension[i] = (char)(tolower(extension[i]));
+        return extension;
     }
 
+    // the format is chosen by the extension: .png, .qoi, anything else is BMP like in TXLib
     inline bool txSaveImage(const char* filename, HDC dc = txDC()) {
-        if (dc == nullptr)
+        if (dc == nullptr || filename == nullptr)
+            return false;
+        txLinUnportableSyncSurface(dc);
+        std::string extension = txLinUnportableImageExtension(filename);
+        if (extension != "png" && extension != "qoi")
+            return (SDL_SaveBMP(txLinUnportableSurfaceOf(dc), filename) == 0);
+        SDL_Surface* surface = txLinUnportableLockSurface(dc);
+        std::vector<Uint32> pixels;
+        bool alpha = false;
+        bool read = txLinUnportableSurfaceToARGB(surface, pixels, &alpha);
+        txLinUnportableUnlockSurface(surface);
+        if (read == false)
+            return false;
+        std::vector<Uint8> encoded;
+        if (extension == "png")
+            txLinUnportableEncodePNG(pixels, surface->w, surface->h, alpha, encoded);
+        else
+            txLinUnportableEncodeQOI(pixels, surface->w, surface->h, alpha, encoded);
+        FILE* file = fopen(filename, "wb");
+        if (file == nullptr) {
+            TXLIN_WARNING("cannot open " + std::string(filename) + " for writing");
             return false;
-        return (SDL_SaveBMP(SDL_GetWindowSurface(SDL_GetWindowFromID(txWindow())), filename) == 0);
+        }
+        bool written = (fwrite(&(encoded[0]), 1, encoded.size(), file) == encoded.size());
+        return (fclose(file) == 0 && written);
     }
 
-    inline HDC txCreateCompatibleDC(double sizeX, double sizeY, HBITMAP bitmap = nullptr) {
-        (void)(bitmap);
-        int width = (int)(sizeX);
-        int height = (int)(sizeY);
-        SDL_PixelFormat* fmt = SDL_GetWindowSurface(SDL_GetWindowFromID(txWindow()))->format;
+    inline bool txStartRecording(const char* filename, double fps = 30, unsigned flags = TX_RECORD_DROP) {
+        if (filename == nullptr || fps <= 0) {
+            TXLIN_WARNING("txStartRecording needs a file name and a positive FPS");
+            return false;
+        }
+        if (txLinUnportableRecorder != nullptr) {
+            TXLIN_WARNING("txStartRecording called while already recording, call txStopRecording first");
+            return false;
+        }
+        SDL_Surface* surface = txLinUnportableCurrentContext()->surface;
+        if (surface == nullptr || surface->format->BytesPerPixel != 4) {
+            TXLIN_WARNING("only a 32-bit window or headless canvas can be recorded");
+            return false;
+        }
+        FILE* file = fopen(filename, "wb");
+        if (file == nullptr) {
+            TXLIN_WARNING("cannot open " + std::string(filename) + " for writing");
+            return false;
+        }
+        TXTYPE_RECORDER* recorder = new TXTYPE_RECORDER();
+        recorder->file = file;
+        recorder->y4m = (txLinUnportableImageExtension(filename) == "y4m");
+        recorder->flags = flags;
+        recorder->width = surface->w;
+        recorder->height = surface->h;
+        recorder->format = surface->format->format;
+        recorder->shifts[0] = surface->format->Rshift;
+        recorder->shifts[1] = surface->format->Gshift;
+        recorder->shifts[2] = surface->format->Bshift;
+        // FPS is kept as a fraction with 1/1000 precision, which is what the Y4M header needs too
+        Uint64 numerator = (Uint64)(fps * 1000 + 0.5);
+        Uint64 denominator = 1000;
+        Uint64 a = numerator;
+        Uint64 b = denominator;
+        while (b != 0) {
+            Uint64 rest = a % b;
+            a = b;
+            b = rest;
+        }
+        if (a != 0) {
+            numerator /= a;
+            denominator /= a;
+        }
+        recorder->fpsNumerator = MAX(numerator, (Uint64)(1));
+        recorder->fpsDenominator = denominator;
+        recorder->pending = -1;
+        recorder->pendingSlot = 0;
+        recorder->droppedSlot = (Uint64)(-1);
+        recorder->buffers.resize(TXLIN_UNPORTABLEDEF_RECORDBUFFERS);
+        for (int i = 0; i < TXLIN_UNPORTABLEDEF_RECORDBUFFERS; i++) {
+            recorder->buffers[i].pixels.resize((size_t)(recorder->width) * recorder->height);
+            recorder->freeBuffers.push_back(i);
+        }
+        if (recorder->y4m)
+            fprintf(file, "YUV4MPEG2 W%d H%d F%llu:%llu Ip A1:1 C420jpeg XYSCSS=420JPEG XCOLORRANGE=FULL\n", recorder->width, recorder->height, (unsigned long long)(recorder->fpsNumerator), (unsigned long long)(recorder->fpsDenominator));
+#ifdef TXLIN_PTHREAD
+        pthread_mutex_init(&(recorder->mutex), nullptr);
+        pthread_cond_init(&(recorder->condition), nullptr);
+        if (pthread_create(&(recorder->writer), nullptr, txLinUnportableRecorderWriter, (void*)(recorder)) != 0) {
+            TXLIN_WARNING("cannot start the thread that writes the recording");
+            pthread_mutex_destroy(&(recorder->mutex));
+            pthread_cond_destroy(&(recorder->condition));
+            fclose(file);
+            delete recorder;
+            return false;
+        }
+#endif
+        // frames still in the buffers are written even if the program just returns from main()
+        static bool exitHandler = (atexit(txLinUnportableStopRecordingAtExit) == 0);
+        (void)(exitHandler);
+        recorder->start = txGetTimeNs();
+        txLinUnportableRecorderDropped = 0;
+        txLinUnportableRecorder = recorder;
+        return true;
+    }
+
+    inline bool txIsRecording() {
+        return (txLinUnportableRecorder != nullptr);
+    }
+
+    inline unsigned long txGetDroppedFrames() {
+        if (txLinUnportableRecorder != nullptr)
+            return txLinUnportableRecorder->dropped;
+        return txLinUnportableRecorderDropped;
+    }
+
+    // a memory DC laid out like the window; with alpha, the byte the window does not use for color holds it
+    inline HDC txLinUnportableCreateDC(int width, int height, bool alpha) {
+        SDL_Surface* windowSurface = txLinUnportableCurrentContext()->surface;
+        SDL_PixelFormat* fmt = (windowSurface != nullptr) ? windowSurface->format : nullptr;
         if (fmt == nullptr) {
             TXLIN_WARNING(SDL_GetError());
             return nullptr;
         }
-        SDL_Surface* sfc = SDL_CreateRGBSurface(0, width, height, fmt->BitsPerPixel, fmt->Rmask, fmt->Gmask, fmt->Bmask, fmt->Amask);
+        Uint32 alphaMask = fmt->Amask;
+        if (alpha && alphaMask == 0 && fmt->BytesPerPixel == 4) {
+            Uint32 colorMask = fmt->Rmask | fmt->Gmask | fmt->Bmask;
+            int alphaShift = 0;
+            while (alphaShift < 24 && (colorMask & (0xFFu << alphaShift)) != 0)
+                alphaShift += 8;
+            alphaMask = 0xFFu << alphaShift;
+        }
+        SDL_Surface* sfc = SDL_CreateRGBSurface(0, width, height, fmt->BitsPerPixel, fmt->Rmask, fmt->Gmask, fmt->Bmask, alphaMask);
         if (sfc == nullptr) {
             TXLIN_WARNING(SDL_GetError());
             return nullptr;
@@ -1960,87 +5017,406 @@ namespace TX {
         SDL_Renderer* rdr = SDL_CreateSoftwareRenderer(sfc);
         if (rdr == nullptr) {
             TXLIN_WARNING(SDL_GetError());
-            SDL_free(sfc);
+            SDL_FreeSurface(sfc);
             return nullptr;
         }
-        TXTYPE_SDLSURFRENDER rtype = { sfc, rdr };
-        txLinUnportableDCSurfaces.push_back(rtype);
+        txLinUnportableRegisterDC(sfc, rdr, true);
         return rdr;
     }
 
+    inline HDC txCreateCompatibleDC(double sizeX, double sizeY, HBITMAP bitmap = nullptr) {
+        (void)(bitmap);
+        return txLinUnportableCreateDC((int)(sizeX), (int)(sizeY), false);
+    }
+
 
     inline SDL_Surface* txLinUnportableFindTheCorrectSurfaceByRenderer(HDC dc, bool nullify = false) {
-        for (int i = 0; i < txLinUnportableDCSurfaces.size(); i++) {
-            if (txLinUnportableDCSurfaces.at(i).surface != nullptr && txLinUnportableDCSurfaces.at(i).renderer == dc) {
-                SDL_Surface* retSurface = txLinUnportableDCSurfaces.at(i).surface;
-                if (nullify) {
-                    txLinUnportableDCSurfaces[i].surface = nullptr;
-                    txLinUnportableDCSurfaces[i].renderer = nullptr;
-                }
-                return retSurface;
+        if (nullify)
+            return txLinUnportableUnregisterDC(dc);
+        TXTYPE_SDLSURFRENDER* entry = txLinUnportableFindDCEntry(dc);
+        return (entry != nullptr) ? entry->surface : nullptr;
+    }
+
+    inline bool txLinUnportableReadImage(const char* filename, TXTYPE_IMAGECACHE& image) {
+        std::string extension = txLinUnportableImageExtension(filename);
+        if (extension != "png" && extension != "qoi") {
+            SDL_Surface* bitmap = SDL_LoadBMP(filename);
+            if (bitmap == nullptr)
+                return false;
+            // 32-bit bitmaps made for TXLib's txAlphaBlend are already premultiplied, so they are read as they are
+            SDL_Surface* converted = SDL_ConvertSurfaceFormat(bitmap, (bitmap->format->Amask != 0) ? SDL_PIXELFORMAT_ARGB8888 : SDL_PIXELFORMAT_RGB888, 0);
+            SDL_FreeSurface(bitmap);
+            if (converted == nullptr)
+                return false;
+            image.width = converted->w;
+            image.height = converted->h;
+            image.alpha = (converted->format->Amask != 0);
+            image.pixels.resize((size_t)(image.width) * image.height);
+            for (int y = 0; y < image.height; y++)
+                memcpy(&(image.pixels[(size_t)(y) * image.width]), (Uint8*)(converted->pixels) + y * converted->pitch, image.width * 4);
+            SDL_FreeSurface(converted);
+            return true;
+        }
+        FILE* file = fopen(filename, "rb");
+        if (file == nullptr)
+            return false;
+        std::vector<Uint8> data;
+        Uint8 block[65536];
+        size_t count = 0;
+        while ((count = fread(block, 1, sizeof(block), file)) > 0)
+            data.insert(data.end(), block, block + count);
+        fclose(file);
+        if (data.empty())
+            return false;
+        bool decoded = (extension == "png") ? txLinUnportableDecodePNG(&(data[0]), data.size(), image.pixels, &(image.width), &(image.height)) : txLinUnportableDecodeQOI(&(data[0]), data.size(), image.pixels, &(image.width), &(image.height));
+        if (decoded == false)
+            return false;
+        // PNG and QOI store straight alpha, DCs keep it premultiplied for txAlphaBlend
+        image.alpha = false;
+        for (size_t i = 0; i < image.pixels.size(); i++) {
+            Uint32 pixel = image.pixels[i];
+            Uint32 a = pixel >> 24;
+            if (a == 255)
+                continue;
+            image.alpha = true;
+            Uint32 r = (((pixel >> 16) & 0xFF) * a + 127) / 255;
+            Uint32 g = (((pixel >> 8) & 0xFF) * a + 127) / 255;
+            Uint32 b = ((pixel & 0xFF) * a + 127) / 255;
+            image.pixels[i] = (a << 24) | (r << 16) | (g << 8) | b;
+        }
+        return true;
+    }
+
+    // the least recently loaded images are forgotten first
+    inline void txLinUnportableTrimImageCache() {
+        while (txLinUnportableImageCacheBytes > TXLIN_UNPORTABLEDEF_IMAGECACHEBYTES && txLinUnportableImageCache.size() > 1) {
+            std::map<std::string, TXTYPE_IMAGECACHE>::iterator oldest = txLinUnportableImageCache.begin();
+            for (std::map<std::string, TXTYPE_IMAGECACHE>::iterator it = txLinUnportableImageCache.begin(); it != txLinUnportableImageCache.end(); ++it) {
+                if (it->second.lastUse < oldest->second.lastUse)
+                    oldest = it;
             }
+            txLinUnportableImageCacheBytes -= oldest->second.pixels.size() * sizeof(Uint32);
+            txLinUnportableImageCache.erase(oldest);
         }
-        return nullptr;
+    }
+
+    inline HDC txLoadImage(const char* filename, unsigned imageFlags = IMAGE_BITMAP, unsigned loadFlags = LR_LOADFROMFILE) {
+        (void)(imageFlags);
+        (void)(loadFlags);
+        if (filename == nullptr)
+            return nullptr;
+        struct stat info;
+        if (stat(filename, &info) != 0) {
+            TXLIN_WARNING("cannot open " + std::string(filename));
+            return nullptr;
+        }
+        // a file is decoded again only if it was changed since the last load
+        std::map<std::string, TXTYPE_IMAGECACHE>::iterator found = txLinUnportableImageCache.find(filename);
+        if (found == txLinUnportableImageCache.end() || found->second.modified != info.st_mtime || found->second.fileSize != info.st_size) {
+            TXTYPE_IMAGECACHE image;
+            if (txLinUnportableReadImage(filename, image) == false) {
+                TXLIN_WARNING(std::string(filename) + " is not a BMP, PNG or QOI image TXLin can read");
+                return nullptr;
+            }
+            image.modified = info.st_mtime;
+            image.fileSize = info.st_size;
+            if (found != txLinUnportableImageCache.end()) {
+                txLinUnportableImageCacheBytes -= found->second.pixels.size() * sizeof(Uint32);
+                txLinUnportableImageCache.erase(found);
+            }
+            found = txLinUnportableImageCache.insert(std::make_pair(std::string(filename), image)).first;
+            txLinUnportableImageCacheBytes += image.pixels.size() * sizeof(Uint32);
+        }
+        found->second.lastUse = ++txLinUnportableImageCacheClock;
+        const TXTYPE_IMAGECACHE& image = found->second;
+        // every call returns a DC of its own that can be drawn on and deleted, only the decoding is shared
+        HDC dc = txLinUnportableCreateDC(image.width, image.height, image.alpha);
+        if (dc == nullptr)
+            return nullptr;
+        SDL_Surface* surface = txLinUnportableSurfaceOf(dc);
+        if (surface == nullptr) {
+            txDeleteDC(dc);
+            return nullptr;
+        }
+        if (SDL_MUSTLOCK(surface))
+            SDL_LockSurface(surface);
+        const SDL_PixelFormat* fmt = surface->format;
+        for (int y = 0; y < image.height; y++) {
+            const Uint32* row = &(image.pixels[(size_t)(y) * image.width]);
+            for (int x = 0; x < image.width; x++) {
+                Uint32 pixel = row[x];
+                if (fmt->BytesPerPixel == 4)
+                    ((Uint32*)((Uint8*)(surface->pixels) + y * surface->pitch))[x] = (((pixel >> 16) & 0xFF) << fmt->Rshift) | (((pixel >> 8) & 0xFF) << fmt->Gshift) | ((pixel & 0xFF) << fmt->Bshift) | (((pixel >> 24) << fmt->Ashift) & fmt->Amask);
+                else
+                    txLinUnportablePutPixel(surface, x, y, SDL_MapRGBA(surface->format, (Uint8)(pixel >> 16), (Uint8)(pixel >> 8), (Uint8)(pixel), (Uint8)(pixel >> 24)));
+            }
+        }
+        if (SDL_MUSTLOCK(surface))
+            SDL_UnlockSurface(surface);
+        txLinUnportableTrimImageCache();
+        return dc;
     }
 
     inline bool txDeleteDC(HDC dc) {
         if (dc == nullptr)
             return false;
+        TXTYPE_SDLSURFRENDER* entry = txLinUnportableFindDCEntry(dc);
+        // only DCs from txCreateCompatibleDC own their surface, the window's one belongs to SDL
+        if (entry == nullptr || entry->offscreen == false)
+            return false;
         SDL_Surface* sfc = txLinUnportableFindTheCorrectSurfaceByRenderer(dc, true);
+#ifdef TXLIN_PTHREAD
+        txLinUnportableDestroyDCLock(dc);
+#endif
         SDL_DestroyRenderer(dc);
-        SDL_free(sfc);
+        SDL_FreeSurface(sfc);
         return true;
     }
 
-#ifdef TXLIN_BUILTINBLT
-#warning "You won't be able to use TXCairo until you disable built-in txBitBlt implementation that does not work at all."
+#ifndef TXLIN_NO_BUILTINBLT
+    inline Uint32 txLinUnportableDiv255(Uint32 value) {
+        value += 128;
+        return (value + (value >> 8)) >> 8;
+    }
 
-    inline bool txBitBlt(HDC destImage, double xDest, double yDest, double width = 0.0, double height = 0.0, HDC sourceImage = txDC(), double xSource = 0.0, double ySource = 0.0) {
-        if (sourceImage == nullptr || destImage == nullptr)
+#ifdef __SSE2__
+    inline __m128i txLinUnportableDiv255SSE2(__m128i value) {
+        value = _mm_add_epi16(value, _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(value, _mm_srli_epi16(value, 8)), 8);
+    }
+
+    // four premultiplied pixels: source * alpha + destination * (1 - source alpha * alpha)
+    inline __m128i txLinUnportableBlendSSE2(__m128i source, __m128i destination, __m128i constAlpha, __m128i alphaShift, __m128i alphaForce) {
+        __m128i zero = _mm_setzero_si128();
+        source = _mm_or_si128(source, alphaForce);
+        __m128i sourceLow = txLinUnportableDiv255SSE2(_mm_mullo_epi16(_mm_unpacklo_epi8(source, zero), constAlpha));
+        __m128i sourceHigh = txLinUnportableDiv255SSE2(_mm_mullo_epi16(_mm_unpackhi_epi8(source, zero), constAlpha));
+        source = _mm_packus_epi16(sourceLow, sourceHigh);
+        __m128i alpha = _mm_and_si128(_mm_srl_epi32(source, alphaShift), _mm_set1_epi32(0xFF));
+        alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 8));
+        alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+        __m128i inverse = _mm_xor_si128(alpha, _mm_set1_epi32(-1));
+        __m128i destinationLow = txLinUnportableDiv255SSE2(_mm_mullo_epi16(_mm_unpacklo_epi8(destination, zero), _mm_unpacklo_epi8(inverse, zero)));
+        __m128i destinationHigh = txLinUnportableDiv255SSE2(_mm_mullo_epi16(_mm_unpackhi_epi8(destination, zero), _mm_unpackhi_epi8(inverse, zero)));
+        return _mm_adds_epu8(source, _mm_packus_epi16(destinationLow, destinationHigh));
+    }
+#endif
+
+#ifdef __AVX2__
+    inline __m256i txLinUnportableDiv255AVX2(__m256i value) {
+        value = _mm256_add_epi16(value, _mm256_set1_epi16(128));
+        return _mm256_srli_epi16(_mm256_add_epi16(value, _mm256_srli_epi16(value, 8)), 8);
+    }
+
+    // same as the SSE2 version, unpacking and packing both work per 128-bit lane so the pixel order is kept
+    inline __m256i txLinUnportableBlendAVX2(__m256i source, __m256i destination, __m256i constAlpha, __m128i alphaShift, __m256i alphaForce) {
+        __m256i zero = _mm256_setzero_si256();
+        source = _mm256_or_si256(source, alphaForce);
+        __m256i sourceLow = txLinUnportableDiv255AVX2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(source, zero), constAlpha));
+        __m256i sourceHigh = txLinUnportableDiv255AVX2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(source, zero), constAlpha));
+        source = _mm256_packus_epi16(sourceLow, sourceHigh);
+        __m256i alpha = _mm256_and_si256(_mm256_srl_epi32(source, alphaShift), _mm256_set1_epi32(0xFF));
+        alpha = _mm256_or_si256(alpha, _mm256_slli_epi32(alpha, 8));
+        alpha = _mm256_or_si256(alpha, _mm256_slli_epi32(alpha, 16));
+        __m256i inverse = _mm256_xor_si256(alpha, _mm256_set1_epi32(-1));
+        __m256i destinationLow = txLinUnportableDiv255AVX2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(destination, zero), _mm256_unpacklo_epi8(inverse, zero)));
+        __m256i destinationHigh = txLinUnportableDiv255AVX2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(destination, zero), _mm256_unpackhi_epi8(inverse, zero)));
+        return _mm256_adds_epu8(source, _mm256_packus_epi16(destinationLow, destinationHigh));
+    }
+#endif
+
+    inline void txLinUnportableBlitRowColorKey(Uint32* destination, const Uint32* source, int count, Uint32 key, Uint32 colorMask) {
+        int i = 0;
+#ifdef __AVX2__
+        __m256i key8 = _mm256_set1_epi32((int)(key));
+        __m256i mask8 = _mm256_set1_epi32((int)(colorMask));
+        for (; i + 8 <= count; i += 8) {
+            __m256i pixels = _mm256_loadu_si256((const __m256i*)(source + i));
+            __m256i old = _mm256_loadu_si256((const __m256i*)(destination + i));
+            __m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(pixels, mask8), key8);
+            _mm256_storeu_si256((__m256i*)(destination + i), _mm256_blendv_epi8(pixels, old, transparent));
+        }
+#endif
+#ifdef __SSE2__
+        __m128i key4 = _mm_set1_epi32((int)(key));
+        __m128i mask4 = _mm_set1_epi32((int)(colorMask));
+        for (; i + 4 <= count; i += 4) {
+            __m128i pixels = _mm_loadu_si128((const __m128i*)(source + i));
+            __m128i old = _mm_loadu_si128((const __m128i*)(destination + i));
+            __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(pixels, mask4), key4);
+            _mm_storeu_si128((__m128i*)(destination + i), _mm_or_si128(_mm_and_si128(transparent, old), _mm_andnot_si128(transparent, pixels)));
+        }
+#endif
+        for (; i < count; i++) {
+            if ((source[i] & colorMask) != key)
+                destination[i] = source[i];
+        }
+    }
+
+    inline void txLinUnportableBlitRowAlpha(Uint32* destination, const Uint32* source, int count, Uint32 constAlpha, int alphaShift, Uint32 alphaForce) {
+        int i = 0;
+#ifdef __AVX2__
+        __m256i constAlpha16 = _mm256_set1_epi16((short)(constAlpha));
+        __m256i force8 = _mm256_set1_epi32((int)(alphaForce));
+        __m128i shift = _mm_cvtsi32_si128(alphaShift);
+        for (; i + 8 <= count; i += 8) {
+            __m256i pixels = _mm256_loadu_si256((const __m256i*)(source + i));
+            __m256i old = _mm256_loadu_si256((const __m256i*)(destination + i));
+            _mm256_storeu_si256((__m256i*)(destination + i), txLinUnportableBlendAVX2(pixels, old, constAlpha16, shift, force8));
+        }
+#endif
+#ifdef __SSE2__
+        __m128i constAlpha8 = _mm_set1_epi16((short)(constAlpha));
+        __m128i force4 = _mm_set1_epi32((int)(alphaForce));
+        __m128i shift4 = _mm_cvtsi32_si128(alphaShift);
+        for (; i + 4 <= count; i += 4) {
+            __m128i pixels = _mm_loadu_si128((const __m128i*)(source + i));
+            __m128i old = _mm_loadu_si128((const __m128i*)(destination + i));
+            _mm_storeu_si128((__m128i*)(destination + i), txLinUnportableBlendSSE2(pixels, old, constAlpha8, shift4, force4));
+        }
+#endif
+        for (; i < count; i++) {
+            Uint32 pixel = source[i] | alphaForce;
+            Uint32 premultiplied[4];
+            for (int channel = 0; channel < 4; channel++)
+                premultiplied[channel] = txLinUnportableDiv255(((pixel >> (channel * 8)) & 0xFF) * constAlpha);
+            Uint32 inverse = 255 - premultiplied[alphaShift / 8];
+            Uint32 result = 0;
+            for (int channel = 0; channel < 4; channel++) {
+                Uint32 value = premultiplied[channel] + txLinUnportableDiv255(((destination[i] >> (channel * 8)) & 0xFF) * inverse);
+                result |= MIN(value, (Uint32)(255)) << (channel * 8);
+            }
+            destination[i] = result;
+        }
+    }
+
+    // clips both rectangles, brings the source to the destination's pixel layout and runs a row kernel over them
+    inline bool txLinUnportableBlit(HDC destImage, double xDest, double yDest, double width, double height, HDC sourceImage, double xSource, double ySource, int mode, COLORREF transColor, double alpha) {
+        if (destImage == nullptr || sourceImage == nullptr)
             return false;
-        SDL_Rect rectBlit = { (int)(xDest), (int)(yDest), (int)(width), (int)(height) };
-        SDL_Rect rectOrig = { (int)(xSource), (int)(ySource), -1, -1 };
-        SDL_Surface* destSfc = txLinUnportableFindTheCorrectSurfaceByRenderer(destImage);
-        SDL_Surface* sourceSfc = txLinUnportableFindTheCorrectSurfaceByRenderer(sourceImage);
-        if (sourceImage == nullptr || destImage == nullptr)
+        TXLIN_UNPORTABLEDEF_STATSCOPE(TX_STAT_BLIT);
+        SDL_Surface* destSfc = txLinUnportableLockSurface(destImage);
+        if (destSfc == nullptr)
             return false;
-        rectOrig.w = sourceSfc->w;
-        rectOrig.h = sourceSfc->h;
-        if (SDL_BlitSurface(sourceSfc, &rectOrig, destSfc, &rectBlit) != 0) {
-            TXLIN_WARNING(SDL_GetError());
+        SDL_Surface* sourceSfc = (sourceImage == destImage) ? destSfc : txLinUnportableLockSurface(sourceImage);
+        if (sourceSfc == nullptr || destSfc->format->BytesPerPixel != 4) {
+            if (sourceSfc != nullptr && sourceSfc != destSfc)
+                txLinUnportableUnlockSurface(sourceSfc);
+            txLinUnportableUnlockSurface(destSfc);
+            TXLIN_WARNING("blits are only supported between 32-bit surfaces");
             return false;
         }
+        int dx = (int)(xDest);
+        int dy = (int)(yDest);
+        int sx = (int)(xSource);
+        int sy = (int)(ySource);
+        // like in TXLib, zero size means the whole source image
+        int w = (width > 0.0) ? (int)(width) : sourceSfc->w - sx;
+        int h = (height > 0.0) ? (int)(height) : sourceSfc->h - sy;
+        if (sx < 0) {
+            dx -= sx;
+            w += sx;
+            sx = 0;
+        }
+        if (sy < 0) {
+            dy -= sy;
+            h += sy;
+            sy = 0;
+        }
+        if (dx < 0) {
+            sx -= dx;
+            w += dx;
+            dx = 0;
+        }
+        if (dy < 0) {
+            sy -= dy;
+            h += dy;
+            dy = 0;
+        }
+        w = MIN(w, MIN(sourceSfc->w - sx, destSfc->w - dx));
+        h = MIN(h, MIN(sourceSfc->h - sy, destSfc->h - dy));
+        txLinUnportableAddDamage(destImage, dx, dy, w, h);
+        TXLIN_UNPORTABLEDEF_STATPIXELS((Uint64)(MAX(w, 0)) * MAX(h, 0));
+
+        SDL_PixelFormat* fmt = destSfc->format;
+        Uint32 colorMask = fmt->Rmask | fmt->Gmask | fmt->Bmask;
+        int alphaShift = 0;
+        while (alphaShift < 24 && (colorMask & (0xFFu << alphaShift)) != 0)
+            alphaShift += 8;
+        bool sourceHasAlpha = (sourceSfc->format->Amask != 0);
+        SDL_Surface* converted = nullptr;
+        bool sameLayout = (sourceSfc->format->format == fmt->format);
+        if (w > 0 && h > 0 && sameLayout == false) {
+            // keep the source alpha in the byte the destination does not use for color
+            Uint32 convertedFormat = SDL_MasksToPixelFormatEnum(32, fmt->Rmask, fmt->Gmask, fmt->Bmask, 0xFFu << alphaShift);
+            // images from txLoadImage are already stored like that
+            sameLayout = (sourceSfc->format->format == convertedFormat);
+            if (sameLayout == false)
+                converted = SDL_ConvertSurfaceFormat(sourceSfc, convertedFormat, 0);
+            if (sameLayout == false && converted == nullptr)
+                TXLIN_WARNING("SDL_GetError() reports: " + std::string(SDL_GetError()) + ", blit failed");
+        }
+        if (w > 0 && h > 0 && (converted != nullptr || sameLayout)) {
+            SDL_Surface* pixelSource = (converted != nullptr) ? converted : sourceSfc;
+            const Uint32* sourceRow = (const Uint32*)((const Uint8*)(pixelSource->pixels) + sy * pixelSource->pitch) + sx;
+            int sourceStride = pixelSource->pitch / 4;
+            // blitting a DC onto itself goes through a copy, the kernels work in place
+            std::vector<Uint32> overlapCopy;
+            if (pixelSource == destSfc) {
+                overlapCopy.resize((size_t)(w) * h);
+                for (int row = 0; row < h; row++)
+                    memcpy(&(overlapCopy[(size_t)(row) * w]), sourceRow + row * sourceStride, w * 4);
+                sourceRow = &(overlapCopy[0]);
+                sourceStride = w;
+            }
+            Uint32 key = txLinUnportableMapColor(destSfc, transColor) & colorMask;
+            Uint32 constAlpha = (Uint32)(MAX(0, MIN(255, (int)(alpha * 255.0 + 0.5))));
+            Uint32 alphaForce = (sourceHasAlpha || converted != nullptr) ? 0 : (0xFFu << alphaShift);
+            if (mode == TXLIN_UNPORTABLEDEF_BLIT_ALPHA && constAlpha == 255 && alphaForce != 0)
+                mode = TXLIN_UNPORTABLEDEF_BLIT_COPY;
+            for (int row = 0; row < h; row++) {
+                Uint32* destRow = (Uint32*)((Uint8*)(destSfc->pixels) + (dy + row) * destSfc->pitch) + dx;
+                if (mode == TXLIN_UNPORTABLEDEF_BLIT_COLORKEY)
+                    txLinUnportableBlitRowColorKey(destRow, sourceRow, w, key, colorMask);
+                else if (mode == TXLIN_UNPORTABLEDEF_BLIT_ALPHA)
+                    txLinUnportableBlitRowAlpha(destRow, sourceRow, w, constAlpha, alphaShift, alphaForce);
+                else
+                    memcpy(destRow, sourceRow, w * 4);
+                sourceRow += sourceStride;
+            }
+        }
+        if (converted != nullptr)
+            SDL_FreeSurface(converted);
+        if (sourceSfc != destSfc)
+            txLinUnportableUnlockSurface(sourceSfc);
+        txLinUnportableUnlockSurface(destSfc);
+        txLinUnportableCommitDrawing();
         return true;
     }
 
+    inline bool txBitBlt(HDC destImage, double xDest, double yDest, double width = 0.0, double height = 0.0, HDC sourceImage = txDC(), double xSource = 0.0, double ySource = 0.0) {
+        return txLinUnportableBlit(destImage, xDest, yDest, width, height, sourceImage, xSource, ySource, TXLIN_UNPORTABLEDEF_BLIT_COPY, TX_BLACK, 1.0);
+    }
+
     inline bool txBitBlt(double xDest, double yDest, HDC sourceImage, double xSource = 0.0, double ySource = 0.0) {
-        SDL_Surface* sfc = txLinUnportableFindTheCorrectSurfaceByRenderer(sourceImage);
-        if (sfc == nullptr)
-            return false;
-        return txBitBlt(txDC(), xDest, yDest, (double)(sfc->w), (double)(sfc->h), sourceImage, xSource, ySource);
+        return txBitBlt(txDC(), xDest, yDest, 0.0, 0.0, sourceImage, xSource, ySource);
     }
 
     inline bool txTransparentBlt(HDC destImage, double xDest, double yDest, double width, double height, HDC sourceImage, double xSource = 0.0, double ySource = 0.0, COLORREF transColor = TX_BLACK) {
-        return txBitBlt(destImage, xDest, yDest, width, height, sourceImage, xSource, ySource);
+        return txLinUnportableBlit(destImage, xDest, yDest, width, height, sourceImage, xSource, ySource, TXLIN_UNPORTABLEDEF_BLIT_COLORKEY, transColor, 1.0);
     }
 
     inline bool txTransparentBlt(double xDest, double yDest, HDC sourceImage, COLORREF transColor = TX_BLACK, double xSource = 0.0, double ySource = 0.0) {
-        (void)(transColor);
-        return txBitBlt(xDest, yDest, sourceImage, xSource, ySource);
+        return txTransparentBlt(txDC(), xDest, yDest, 0.0, 0.0, sourceImage, xSource, ySource, transColor);
     }
 
     inline bool txAlphaBlend(HDC destImage, double xDest, double yDest, double width, double height, HDC sourceImage, double xSource = 0.0, double ySource = 0.0, double alpha = 1.0) {
-        (void)(alpha);
-        return txBitBlt(destImage, xDest, yDest, width, height, sourceImage, xSource, ySource);
+        return txLinUnportableBlit(destImage, xDest, yDest, width, height, sourceImage, xSource, ySource, TXLIN_UNPORTABLEDEF_BLIT_ALPHA, TX_BLACK, alpha);
     }
 
     inline bool txAlphaBlend(double xDest, double yDest, HDC sourceImage, double xSource = 0.0, double ySource = 0.0, double alpha = 1.0) {
-        if (sourceImage == nullptr)
-            return false;
-        (void)(alpha);
-        return txBitBlt(xDest, yDest, sourceImage, xSource, ySource);
+        return txAlphaBlend(txDC(), xDest, yDest, 0.0, 0.0, sourceImage, xSource, ySource, alpha);
     }
-
 #endif
 
     #define _txTextOut(x, y, text, renderer) { COLORREF originalColor = txGetColor(); \
@@ -2229,6 +5605,351 @@ namespace TX {
     #undef _txthreaddummy_INTERNALS_warning
 #endif
 
+    inline int txGetThreadCount() {
+#ifdef TXLIN_PTHREAD
+        // TXLIN_THREADS overrides the core count, mostly for benchmarks
+        if (getenv("TXLIN_THREADS") != nullptr && atoi(getenv("TXLIN_THREADS")) > 0)
+            return atoi(getenv("TXLIN_THREADS"));
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        return (cores > 0) ? (int)(cores) : 1;
+#else
+        return 1;
+#endif
+    }
+
+#ifdef TXLIN_PTHREAD
+    inline bool txLinUnportablePoolTakeTask(TXTYPE_POOLTASK* task) {
+        int count = txLinUnportablePoolSize.load(std::memory_order_acquire);
+        for (int attempt = 0; attempt < count; attempt++) {
+            int index = (txLinUnportablePoolIndex + attempt) % count;
+            TXTYPE_WORKQUEUE* queue = txLinUnportablePoolQueues[index];
+            pthread_mutex_lock(&(queue->mutex));
+            bool found = (queue->tasks.empty() == false);
+            if (found) {
+                // the newest own task is still hot in the cache, stolen ones are the oldest and usually the largest
+                if (attempt == 0) {
+                    *task = queue->tasks.back();
+                    queue->tasks.pop_back();
+                }
+                else {
+                    *task = queue->tasks.front();
+                    queue->tasks.pop_front();
+                }
+            }
+            pthread_mutex_unlock(&(queue->mutex));
+            if (found) {
+                txLinUnportablePoolQueued--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline void txLinUnportablePoolRunTask(const TXTYPE_POOLTASK& task) {
+        task.function(task.argument);
+        if (task.group != nullptr)
+            task.group->pending.fetch_sub(1, std::memory_order_release);
+    }
+
+    inline void* txLinUnportablePoolWorker(void* param) {
+        txLinUnportablePoolIndex = (int)((intptr_t)(param));
+        TXTYPE_POOLTASK task;
+        while (true) {
+            if (txLinUnportablePoolTakeTask(&task)) {
+                txLinUnportablePoolRunTask(task);
+                continue;
+            }
+            pthread_mutex_lock(&txLinUnportablePoolMutex);
+            while (txLinUnportablePoolQueued.load() == 0)
+                pthread_cond_wait(&txLinUnportablePoolCondition, &txLinUnportablePoolMutex);
+            pthread_mutex_unlock(&txLinUnportablePoolMutex);
+        }
+        return nullptr;
+    }
+
+    inline bool txLinUnportableStartPool() {
+        pthread_mutex_lock(&txLinUnportablePoolMutex);
+        if (txLinUnportablePoolSize.load() == 0) {
+            int threads = txGetThreadCount();
+            txLinUnportablePoolQueues = new TXTYPE_WORKQUEUE*[threads];
+            for (int i = 0; i < threads; i++) {
+                txLinUnportablePoolQueues[i] = new TXTYPE_WORKQUEUE;
+                pthread_mutex_init(&(txLinUnportablePoolQueues[i]->mutex), nullptr);
+            }
+            txLinUnportablePoolSize.store(threads, std::memory_order_release);
+            // the thread waiting for a task group works too, so one thread less is started
+            for (int i = 1; i < threads; i++) {
+                pthread_t worker;
+                if (pthread_create(&worker, nullptr, txLinUnportablePoolWorker, (void*)((intptr_t)(i))) == 0)
+                    pthread_detach(worker);
+            }
+        }
+        pthread_mutex_unlock(&txLinUnportablePoolMutex);
+        return true;
+    }
+#endif
+
+    inline bool txRunTask(TXTYPE_TASKGROUP* group, void (*task)(void*), void* argument = nullptr) {
+        if (group == nullptr || task == nullptr)
+            return false;
+#ifdef TXLIN_PTHREAD
+        if (txLinUnportablePoolSize.load(std::memory_order_acquire) == 0)
+            txLinUnportableStartPool();
+        TXTYPE_POOLTASK poolTask = { task, argument, group };
+        group->pending.fetch_add(1, std::memory_order_relaxed);
+        TXTYPE_WORKQUEUE* queue = txLinUnportablePoolQueues[txLinUnportablePoolIndex];
+        pthread_mutex_lock(&(queue->mutex));
+        queue->tasks.push_back(poolTask);
+        pthread_mutex_unlock(&(queue->mutex));
+        pthread_mutex_lock(&txLinUnportablePoolMutex);
+        txLinUnportablePoolQueued++;
+        pthread_cond_signal(&txLinUnportablePoolCondition);
+        pthread_mutex_unlock(&txLinUnportablePoolMutex);
+#else
+        // without the threads API the task runs right away
+        task(argument);
+#endif
+        return true;
+    }
+
+    inline bool txWaitTasks(TXTYPE_TASKGROUP* group) {
+        if (group == nullptr)
+            return false;
+#ifdef TXLIN_PTHREAD
+        // help instead of sleeping, this also keeps nested task groups from deadlocking
+        TXTYPE_POOLTASK task;
+        while (group->pending.load(std::memory_order_acquire) > 0) {
+            if (txLinUnportablePoolTakeTask(&task))
+                txLinUnportablePoolRunTask(task);
+            else
+                sched_yield();
+        }
+#endif
+        return true;
+    }
+
+    template <typename Function> inline void txLinUnportableParallelForChunk(void* param) {
+        TXTYPE_PARALLELFORCHUNK<Function>* chunk = (TXTYPE_PARALLELFORCHUNK<Function>*)(param);
+        for (int i = chunk->begin; i < chunk->end; i++)
+            (*(chunk->function))(i);
+    }
+
+    // calls function(i) for every i in [begin, end), split into chunks of grain iterations
+    template <typename Function> inline bool txParallelFor(int begin, int end, Function function, int grain = 0) {
+        if (end <= begin)
+            return true;
+        int threads = txGetThreadCount();
+        if (grain <= 0)
+            grain = MAX(1, (end - begin) / (threads * 8));
+        if (threads == 1 || end - begin <= grain) {
+            for (int i = begin; i < end; i++)
+                function(i);
+            return true;
+        }
+        std::vector<TXTYPE_PARALLELFORCHUNK<Function> > chunks;
+        for (int start = begin; start < end; start += grain) {
+            TXTYPE_PARALLELFORCHUNK<Function> chunk = { &function, start, MIN(end, start + grain) };
+            chunks.push_back(chunk);
+        }
+        TXTYPE_TASKGROUP group;
+        for (size_t i = 0; i < chunks.size(); i++)
+            txRunTask(&group, txLinUnportableParallelForChunk<Function>, &(chunks[i]));
+        return txWaitTasks(&group);
+    }
+
+    inline void txLinUnportableFillPixels(Uint8* row, int bytes, int count, Uint32 color) {
+        if (bytes == 4)
+            std::fill_n((Uint32*)(row), count, color);
+        else if (bytes == 2)
+            std::fill_n((Uint16*)(row), count, (Uint16)(color));
+        else
+            memset(row, (int)(color & 0xFF), (size_t)(count));
+    }
+
+    // clips a piece of a command to the surface and remembers it with its color
+    inline void txLinUnportableAddTiledPiece(std::vector<SDL_Rect>& pieces, std::vector<Uint32>& colors, SDL_Surface* surface, int left, int top, int right, int bottom, Uint32 color) {
+        left = MAX(left, 0);
+        top = MAX(top, 0);
+        right = MIN(right, surface->w);
+        bottom = MIN(bottom, surface->h);
+        if (left >= right || top >= bottom)
+            return;
+        SDL_Rect piece = { left, top, right - left, bottom - top };
+        pieces.push_back(piece);
+        colors.push_back(color);
+    }
+
+    // lines go through SDL, its line algorithm differs between SDL versions; so do outlines it would draw inside out
+    inline bool txLinUnportableTiledCommand(const TXTYPE_DRAWCOMMAND& command) {
+        if (command.type == TXLIN_UNPORTABLEDEF_COMMAND_LINE)
+            return false;
+        if (command.type == TXLIN_UNPORTABLEDEF_COMMAND_RECT)
+            return (command.x1 > command.x0 && command.y1 > command.y0);
+        return true;
+    }
+
+    // everything else is written straight into the surface by the thread pool, one square tile per task;
+    // every tile applies its pieces in the original order, so the pixels are the same as with the SDL software renderer
+    inline bool txLinUnportableFlushTiled(TXTYPE_SDLSURFRENDER* entry) {
+        SDL_Surface* surface = entry->surface;
+        if (surface == nullptr || surface->pixels == nullptr || surface->w <= 0 || surface->h <= 0)
+            return false;
+        int bytes = surface->format->BytesPerPixel;
+        if (bytes != 1 && bytes != 2 && bytes != 4)
+            return false;
+        const std::vector<TXTYPE_DRAWCOMMAND>& commands = entry->commands;
+        int tilesX = (surface->w + TXLIN_UNPORTABLEDEF_TILESIZE - 1) / TXLIN_UNPORTABLEDEF_TILESIZE;
+        int tilesY = (surface->h + TXLIN_UNPORTABLEDEF_TILESIZE - 1) / TXLIN_UNPORTABLEDEF_TILESIZE;
+        std::vector<std::vector<Uint32> > bins((size_t)(tilesX * tilesY));
+        std::vector<int> busyTiles;
+        std::vector<SDL_Rect> pieces;
+        std::vector<Uint32> colors;
+        size_t i = 0;
+        while (i < commands.size()) {
+            if (txLinUnportableTiledCommand(commands[i]) == false) {
+                size_t runEnd = i + 1;
+                while (runEnd < commands.size() && txLinUnportableTiledCommand(commands[runEnd]) == false)
+                    runEnd++;
+                txLinUnportableReplayCommands(entry->renderer, commands, i, runEnd);
+                i = runEnd;
+                continue;
+            }
+            pieces.clear();
+            colors.clear();
+            long pixels = 0;
+            Uint32 color = 0;
+            size_t runEnd = i;
+            for (; runEnd < commands.size() && txLinUnportableTiledCommand(commands[runEnd]); runEnd++) {
+                const TXTYPE_DRAWCOMMAND& command = commands[runEnd];
+                if (runEnd == i || command.r != commands[runEnd - 1].r || command.g != commands[runEnd - 1].g || command.b != commands[runEnd - 1].b)
+                    color = SDL_MapRGBA(surface->format, command.r, command.g, command.b, 0);
+                // same rules as the software renderer: empty fills still cover one pixel, clears ignore clipping
+                if (command.type == TXLIN_UNPORTABLEDEF_COMMAND_FILLRECT)
+                    txLinUnportableAddTiledPiece(pieces, colors, surface, command.x0, command.y0, command.x0 + MAX(command.x1 - command.x0, 1), command.y0 + MAX(command.y1 - command.y0, 1), color);
+                else if (command.type == TXLIN_UNPORTABLEDEF_COMMAND_RECT) {
+                    txLinUnportableAddTiledPiece(pieces, colors, surface, command.x0, command.y0, command.x1, command.y0 + 1, color);
+                    txLinUnportableAddTiledPiece(pieces, colors, surface, command.x0, command.y1 - 1, command.x1, command.y1, color);
+                    txLinUnportableAddTiledPiece(pieces, colors, surface, command.x0, command.y0, command.x0 + 1, command.y1, color);
+                    txLinUnportableAddTiledPiece(pieces, colors, surface, command.x1 - 1, command.y0, command.x1, command.y1, color);
+                }
+                else if (command.type == TXLIN_UNPORTABLEDEF_COMMAND_CLEAR)
+                    txLinUnportableAddTiledPiece(pieces, colors, surface, 0, 0, surface->w, surface->h, color);
+                else
+                    txLinUnportableAddTiledPiece(pieces, colors, surface, command.x0, command.y0, command.x0 + 1, command.y0 + 1, color);
+            }
+            for (size_t j = 0; j < pieces.size(); j++)
+                pixels += (long)(pieces[j].w) * pieces[j].h;
+            // whatever SDL still holds has to land in the surface first
+#if SDL_VERSION_ATLEAST(2, 0, 10)
+            SDL_RenderFlush(entry->renderer);
+#endif
+            if (SDL_MUSTLOCK(surface) && SDL_LockSurface(surface) != 0)
+                return false;
+            // a short piece of work between two lines is not worth waking the pool for
+            if (pixels < TXLIN_UNPORTABLEDEF_TILEDMINPIXELS) {
+                for (size_t j = 0; j < pieces.size(); j++) {
+                    for (int y = pieces[j].y; y < pieces[j].y + pieces[j].h; y++)
+                        txLinUnportableFillPixels((Uint8*)(surface->pixels) + y * surface->pitch + pieces[j].x * bytes, bytes, pieces[j].w, colors[j]);
+                }
+            }
+            else {
+                busyTiles.clear();
+                for (size_t j = 0; j < pieces.size(); j++) {
+                    for (int tileY = pieces[j].y / TXLIN_UNPORTABLEDEF_TILESIZE; tileY <= (pieces[j].y + pieces[j].h - 1) / TXLIN_UNPORTABLEDEF_TILESIZE; tileY++) {
+                        for (int tileX = pieces[j].x / TXLIN_UNPORTABLEDEF_TILESIZE; tileX <= (pieces[j].x + pieces[j].w - 1) / TXLIN_UNPORTABLEDEF_TILESIZE; tileX++) {
+                            std::vector<Uint32>& bin = bins[tileY * tilesX + tileX];
+                            if (bin.empty())
+                                busyTiles.push_back(tileY * tilesX + tileX);
+                            bin.push_back((Uint32)(j));
+                        }
+                    }
+                }
+                txParallelFor(0, (int)(busyTiles.size()), [&](int busy) {
+                    int tile = busyTiles[busy];
+                    int tileLeft = (tile % tilesX) * TXLIN_UNPORTABLEDEF_TILESIZE;
+                    int tileTop = (tile / tilesX) * TXLIN_UNPORTABLEDEF_TILESIZE;
+                    int tileRight = MIN(tileLeft + TXLIN_UNPORTABLEDEF_TILESIZE, surface->w);
+                    int tileBottom = MIN(tileTop + TXLIN_UNPORTABLEDEF_TILESIZE, surface->h);
+                    std::vector<Uint32>& bin = bins[tile];
+                    for (size_t j = 0; j < bin.size(); j++) {
+                        const SDL_Rect& piece = pieces[bin[j]];
+                        int left = MAX(piece.x, tileLeft);
+                        int right = MIN(piece.x + piece.w, tileRight);
+                        int bottom = MIN(piece.y + piece.h, tileBottom);
+                        for (int y = MAX(piece.y, tileTop); y < bottom; y++)
+                            txLinUnportableFillPixels((Uint8*)(surface->pixels) + y * surface->pitch + left * bytes, bytes, right - left, colors[bin[j]]);
+                    }
+                    bin.clear();
+                });
+            }
+            if (SDL_MUSTLOCK(surface))
+                SDL_UnlockSurface(surface);
+            i = runEnd;
+        }
+        return true;
+    }
+
+    inline bool txSetTiledRendering(bool value = true, HDC dc = txDC()) {
+        TXTYPE_SDLSURFRENDER* entry = txLinUnportableFindDCEntry(dc);
+        // only DCs drawn by a software renderer into their own surface can be split into tiles
+        bool software = (entry != nullptr && (entry->offscreen || (txLinUnportableHeadless && dc == txLinUnportableHeadlessContext.renderer)));
+        if (software == false) {
+            TXLIN_WARNING("txSetTiledRendering works only with DCs from txCreateCompatibleDC and with the headless canvas");
+            return false;
+        }
+        if (entry->tiled == value)
+            return true;
+        txLinUnportableFlushCommands(entry);
+        entry->tiled = value;
+        txLinUnportableTiledDCs += (value) ? 1 : -1;
+        return true;
+    }
+
+    inline double txQueryPerformance() {
+        HDC canvas = txCreateCompatibleDC(TXLIN_UNPORTABLEDEF_PERFORMANCESIZE, TXLIN_UNPORTABLEDEF_PERFORMANCESIZE);
+        HDC sprite = txCreateCompatibleDC(32, 32);
+        if (canvas == nullptr || sprite == nullptr) {
+            txDeleteDC(canvas);
+            txDeleteDC(sprite);
+            return 0.0;
+        }
+        COLORREF oldColor = txLinUnportableLastDrawColor;
+        COLORREF oldFillColor = txLinUnportableLastFillColor;
+        int oldThickness = txLinUnportableLineThickness;
+        POINT star[5] = { { 128, 30 }, { 186, 210 }, { 34, 98 }, { 222, 98 }, { 70, 210 } };
+        txSetColor(TX_WHITE, 1, sprite);
+        txSetFillColor(TX_ORANGE, sprite);
+        txCircle(16, 16, 12, sprite);
+        Uint64 frequency = SDL_GetPerformanceFrequency();
+        Uint64 start = SDL_GetPerformanceCounter();
+        Uint64 finish = start + frequency * TXLIN_UNPORTABLEDEF_PERFORMANCETIME / 1000;
+        Uint64 now = start;
+        long iterations = 0;
+        // the same mix of fills, outlines, polygons and blits as a typical TXLib frame
+        while (now < finish) {
+            int shift = (int)(iterations % 64);
+            txSetFillColor(RGB(shift * 4, 64, 255 - shift * 4), canvas);
+            txRectangle(shift, shift, shift + 128, shift + 128, canvas);
+            txSetColor(TX_YELLOW, 1, canvas);
+            txCircle(128, 128, 40 + shift / 4, canvas);
+            txPolygon(star, 5, canvas);
+            txSetColor(TX_LIGHTGREEN, 5, canvas);
+            txLine(0, shift, 255, 255 - shift, canvas);
+            txVideoMemory(canvas);
+#ifndef TXLIN_NO_BUILTINBLT
+            txAlphaBlend(canvas, shift * 3, 200 - shift, 0, 0, sprite, 0, 0, 0.5);
+#endif
+            iterations++;
+            now = SDL_GetPerformanceCounter();
+        }
+        txSetColor(oldColor, oldThickness);
+        txSetFillColor(oldFillColor);
+        txDeleteDC(sprite);
+        txDeleteDC(canvas);
+        double perSecond = (double)(iterations) * frequency / (double)(now - start);
+        return perSecond / TXLIN_UNPORTABLEDEF_PERFORMANCEREFERENCE;
+    }
+
     inline txthread_t txSpiltThread(void (*splitThreadFunc)(bool)) {
         txMessageBox("You've typoed, man. Cure your bad habit of mistyping already.");
         return 0;
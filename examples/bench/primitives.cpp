@@ -0,0 +1,211 @@
+// Primitive benchmark - times every drawing function of TXLin over a fixed
+// workload on memory DCs of a few sizes, without opening a window.
+// Every result is one line of key=value pairs, so the output of two builds
+// of TXLin.h can be compared with a script:
+//
+//   bench=line_t3 canvas=1920x1080 ops=20000 ms=41.2 ns_per_op=2060.0
+//
+// Build: g++ -O2 primitives.cpp -o primitives $(pkg-config --cflags --libs sdl2 SDL2_ttf txlin)
+// Run:   ./primitives [name]   (only the benchmarks whose name contains "name")
+
+#define TXLIN_HEADLESS
+#include <TXLin.h>
+
+struct Canvas {
+    int width;
+    int height;
+};
+
+const Canvas canvases[] = { { 640, 480 }, { 1920, 1080 } };
+const int attempts = 3;
+
+HDC sprite = nullptr;
+
+void randomPoint(const Canvas& canvas, double* x, double* y) {
+    *x = rand() % canvas.width;
+    *y = rand() % canvas.height;
+}
+
+bool benchSetPixel(HDC dc, const Canvas& canvas, int ops) {
+    for (int i = 0; i < ops; i++)
+        txSetPixel(i % canvas.width, (i / canvas.width) % canvas.height, RGB(i & 255, 128, 255 - (i & 255)), dc);
+    return true;
+}
+
+bool benchLine(HDC dc, const Canvas& canvas, int ops, int thickness) {
+    txSetColor(TX_LIGHTGREEN, thickness, dc);
+    for (int i = 0; i < ops; i++) {
+        double x0, y0;
+        randomPoint(canvas, &x0, &y0);
+        txLine(x0, y0, x0 + rand() % 200 - 100, y0 + rand() % 200 - 100, dc);
+    }
+    txSetColor(TX_WHITE, 1, dc);
+    return true;
+}
+
+bool benchLine1(HDC dc, const Canvas& canvas, int ops) {
+    return benchLine(dc, canvas, ops, 1);
+}
+
+bool benchLine3(HDC dc, const Canvas& canvas, int ops) {
+    return benchLine(dc, canvas, ops, 3);
+}
+
+bool benchLine8(HDC dc, const Canvas& canvas, int ops) {
+    return benchLine(dc, canvas, ops, 8);
+}
+
+bool benchRectangle(HDC dc, const Canvas& canvas, int ops) {
+    for (int i = 0; i < ops; i++) {
+        double x, y;
+        randomPoint(canvas, &x, &y);
+        txSetFillColor(RGB(rand() % 256, rand() % 256, rand() % 256), dc);
+        txRectangle(x, y, x + 10 + rand() % 100, y + 10 + rand() % 100, dc);
+    }
+    return true;
+}
+
+bool benchEllipse(HDC dc, const Canvas& canvas, int ops) {
+    for (int i = 0; i < ops; i++) {
+        double x, y;
+        randomPoint(canvas, &x, &y);
+        txSetFillColor(RGB(rand() % 256, rand() % 256, rand() % 256), dc);
+        txEllipse(x, y, x + 10 + rand() % 100, y + 10 + rand() % 60, dc);
+    }
+    return true;
+}
+
+bool benchPolygon(HDC dc, const Canvas& canvas, int ops) {
+    for (int i = 0; i < ops; i++) {
+        double x, y;
+        randomPoint(canvas, &x, &y);
+        int size = 10 + rand() % 80;
+        POINT star[5];
+        for (int j = 0; j < 5; j++) {
+            star[j].x = x + size * cos(j * 4 * M_PI / 5);
+            star[j].y = y + size * sin(j * 4 * M_PI / 5);
+        }
+        txSetFillColor(RGB(rand() % 256, rand() % 256, rand() % 256), dc);
+        txPolygon(star, 5, dc);
+    }
+    return true;
+}
+
+bool benchFloodFill(HDC dc, const Canvas& canvas, int ops) {
+    // the background between a grid of rings is filled again and again in two colors
+    txSetFillColor(TX_BLACK, dc);
+    txClear(dc);
+    txSetColor(TX_WHITE, 1, dc);
+    txSetFillColor(TX_TRANSPARENT, dc);
+    for (int y = 40; y < canvas.height; y += 80) {
+        for (int x = 40; x < canvas.width; x += 80)
+            txCircle(x, y, 30, dc);
+    }
+    for (int i = 0; i < ops; i++) {
+        txSetFillColor((i % 2 == 0) ? TX_BLUE : TX_BLACK, dc);
+        txFloodFill(0, 0, TX_TRANSPARENT, FLOODFILLSURFACE, dc);
+    }
+    return true;
+}
+
+bool benchTextOut(HDC dc, const Canvas& canvas, int ops) {
+    txSetColor(TX_WHITE, 1, dc);
+    for (int i = 0; i < ops; i++) {
+        double x, y;
+        randomPoint(canvas, &x, &y);
+        if (txTextOut(x, y, "The quick brown fox 0123456789", dc) == false)
+            return false;
+    }
+    return true;
+}
+
+#ifndef TXLIN_NO_BUILTINBLT
+bool benchBitBlt(HDC dc, const Canvas& canvas, int ops) {
+    for (int i = 0; i < ops; i++)
+        txBitBlt(dc, rand() % canvas.width - 32, rand() % canvas.height - 32, 0, 0, sprite);
+    return true;
+}
+
+bool benchTransparentBlt(HDC dc, const Canvas& canvas, int ops) {
+    for (int i = 0; i < ops; i++)
+        txTransparentBlt(dc, rand() % canvas.width - 32, rand() % canvas.height - 32, 0, 0, sprite, 0, 0, TX_BLACK);
+    return true;
+}
+
+bool benchAlphaBlend(HDC dc, const Canvas& canvas, int ops) {
+    for (int i = 0; i < ops; i++)
+        txAlphaBlend(dc, rand() % canvas.width - 32, rand() % canvas.height - 32, 0, 0, sprite, 0, 0, 0.5);
+    return true;
+}
+#endif
+
+struct Benchmark {
+    const char* name;
+    int ops;
+    bool (*run)(HDC dc, const Canvas& canvas, int ops);
+};
+
+const Benchmark benchmarks[] = {
+    { "setpixel", 200000, benchSetPixel },
+    { "line_t1", 20000, benchLine1 },
+    { "line_t3", 20000, benchLine3 },
+    { "line_t8", 5000, benchLine8 },
+    { "rectangle", 20000, benchRectangle },
+    { "ellipse", 10000, benchEllipse },
+    { "polygon", 10000, benchPolygon },
+    { "floodfill", 20, benchFloodFill },
+    { "textout", 2000, benchTextOut },
+#ifndef TXLIN_NO_BUILTINBLT
+    { "bitblt", 20000, benchBitBlt },
+    { "transparentblt", 20000, benchTransparentBlt },
+    { "alphablend", 20000, benchAlphaBlend },
+#endif
+};
+
+int main(int argc, char** argv) {
+    const char* filter = (argc > 1) ? argv[1] : "";
+    txCreateWindow(64, 64);
+    sprite = txCreateCompatibleDC(64, 64);
+    txSetFillColor(TX_BLACK, sprite);
+    txClear(sprite);
+    txSetColor(TX_WHITE, 2, sprite);
+    txSetFillColor(TX_ORANGE, sprite);
+    txCircle(32, 32, 28, sprite);
+    txSetColor(TX_WHITE, 1, sprite);
+    printf("suite=primitives threads=%d performance=%.2f\n", txGetThreadCount(), txQueryPerformance());
+    for (size_t c = 0; c < sizeof(canvases) / sizeof(canvases[0]); c++) {
+        const Canvas& canvas = canvases[c];
+        HDC dc = txCreateCompatibleDC(canvas.width, canvas.height);
+        for (size_t b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); b++) {
+            const Benchmark& benchmark = benchmarks[b];
+            if (strstr(benchmark.name, filter) == nullptr)
+                continue;
+            Uint64 best = 0;
+            bool ok = true;
+            for (int attempt = 0; attempt < attempts && ok; attempt++) {
+                srand(2019);
+                txSetFillColor(TX_BLACK, dc);
+                txClear(dc);
+                txVideoMemory(dc);
+                Uint64 start = txGetTimeNs();
+                // like a frame of an animation: queued while drawing, finished by the time the pixels are read
+                txBegin();
+                ok = benchmark.run(dc, canvas, benchmark.ops);
+                txEnd();
+                txVideoMemory(dc);
+                Uint64 time = txGetTimeNs() - start;
+                if (attempt == 0 || time < best)
+                    best = time;
+            }
+            if (ok == false) {
+                printf("bench=%s canvas=%dx%d status=skipped\n", benchmark.name, canvas.width, canvas.height);
+                continue;
+            }
+            printf("bench=%s canvas=%dx%d ops=%d ms=%.2f ns_per_op=%.1f\n", benchmark.name, canvas.width, canvas.height, benchmark.ops, best / 1000000.0, (double)(best) / benchmark.ops);
+            fflush(stdout);
+        }
+        txDeleteDC(dc);
+    }
+    txDeleteDC(sprite);
+    return 0;
+}
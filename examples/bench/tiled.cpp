@@ -0,0 +1,67 @@
+// Tiled rendering benchmark - draws the same 4K scene into two memory DCs,
+// one through the SDL software renderer and one with txSetTiledRendering,
+// then checks that both images are identical.
+//
+// Build: g++ -O2 tiled.cpp -o tiled $(pkg-config --cflags --libs sdl2 txlin)
+// Run with TXLIN_THREADS=1, 2, 4, ... to see how it scales.
+
+#define TXLIN_HEADLESS
+#include <TXLin.h>
+#include <chrono>
+
+const int width = 3840;
+const int height = 2160;
+
+void drawScene(HDC dc) {
+    srand(2019);
+    txSetFillColor(TX_BLACK, dc);
+    txClear(dc);
+    for (int i = 0; i < 4000; i++) {
+        // outlines of thickness 1 are drawn by SDL either way, so the scene uses fills and thick lines
+        txSetColor(RGB(rand() % 256, rand() % 256, rand() % 256), 3, dc);
+        txSetFillColor(RGB(rand() % 256, rand() % 256, rand() % 256), dc);
+        int x = rand() % width;
+        int y = rand() % height;
+        int size = 20 + rand() % 300;
+        if (i % 4 == 0)
+            txCircle(x, y, size, dc);
+        else if (i % 4 == 1)
+            txRectangle(x, y, x + size, y + size / 2, dc);
+        else if (i % 4 == 2)
+            txLine(x, y, x + size, y + size / 3, dc);
+        else {
+            POINT star[5];
+            for (int j = 0; j < 5; j++) {
+                star[j].x = x + size * cos(j * 4 * M_PI / 5);
+                star[j].y = y + size * sin(j * 4 * M_PI / 5);
+            }
+            txPolygon(star, 5, dc);
+        }
+    }
+    // makes the whole scene land in memory
+    txVideoMemory(dc);
+}
+
+double measure(HDC dc) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    drawScene(dc);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    txCreateWindow(64, 64);
+    HDC serial = txCreateCompatibleDC(width, height);
+    HDC tiled = txCreateCompatibleDC(width, height);
+    txSetTiledRendering(true, tiled);
+    double serialTime = 1e9;
+    double tiledTime = 1e9;
+    for (int attempt = 0; attempt < 3; attempt++) {
+        serialTime = MIN(serialTime, measure(serial));
+        tiledTime = MIN(tiledTime, measure(tiled));
+    }
+    bool identical = (memcmp(txVideoMemory(serial), txVideoMemory(tiled), (size_t)(width) * height * sizeof(RGBQUAD)) == 0);
+    printf("threads=%d serial_ms=%.1f tiled_ms=%.1f speedup=%.2f identical=%s\n", txGetThreadCount(), serialTime, tiledTime, serialTime / tiledTime, (identical) ? "yes" : "no");
+    txDeleteDC(serial);
+    txDeleteDC(tiled);
+    return (identical) ? 0 : 1;
+}
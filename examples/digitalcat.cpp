@@ -34,7 +34,7 @@ static COLORREF lawnGreen = { 124, 252, 0 }; // a variable which stores the colo
 static bool doRedraw = true; // a variable controlling the redraw capabilties
 
 void seperateThreadDrawingFunction(bool insideRealThread) {
-	if (insideRealThread == false || txIsMacOS())
+	if (insideRealThread == false)
 		return;
 	while (true) {
 		if (doRedraw) {